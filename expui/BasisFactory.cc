@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <sstream>
 
 #include <YamlCheck.H>
 #include <EXPException.H>
@@ -229,6 +230,47 @@ namespace BasisClasses
   {
     return crt_eval(x, y, z);
   }
+
+  void Basis::checkFieldsBatch(const Eigen::Ref<const RowMatrixXd>& pos,
+			       const Eigen::Ref<RowMatrixXd>& out)
+  {
+    int nfld = getFieldLabels(Coord::Cartesian).size();
+
+    if (pos.cols() != 3) {
+      std::ostringstream sout;
+      sout << "Basis::getFieldsBatch: position array has " << pos.cols()
+	   << " columns, expected 3";
+      throw std::runtime_error(sout.str());
+    }
+
+    if (out.rows() != pos.rows() or out.cols() != nfld) {
+      std::ostringstream sout;
+      sout << "Basis::getFieldsBatch: output array is " << out.rows()
+	   << "x" << out.cols() << ", expected " << pos.rows()
+	   << "x" << nfld;
+      throw std::runtime_error(sout.str());
+    }
+  }
+
+  void Basis::getFieldsBatch(const Eigen::Ref<const RowMatrixXd>& pos,
+			     Eigen::Ref<RowMatrixXd> out)
+  {
+    checkFieldsBatch(pos, out);
+
+    for (int n=0; n<pos.rows(); n++) {
+      auto v = getFields(pos(n, 0), pos(n, 1), pos(n, 2));
+      if (static_cast<int>(v.size()) != out.cols())
+	throw std::runtime_error("Basis::getFieldsBatch: field count mismatch");
+      for (int k=0; k<out.cols(); k++) out(n, k) = v[k];
+    }
+  }
+
+  RowMatrixXd Basis::getFieldsBatch(const Eigen::Ref<const RowMatrixXd>& pos)
+  {
+    RowMatrixXd out(pos.rows(), getFieldLabels(Coord::Cartesian).size());
+    getFieldsBatch(pos, out);
+    return out;
+  }
     
   std::tuple<std::map<std::string, Eigen::VectorXd>, Eigen::VectorXd>
   Basis::getFieldsCoefs
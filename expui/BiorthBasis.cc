@@ -1,4 +1,7 @@
 #include <algorithm>
+#include <future>
+
+#include <highfive/highfive.hpp>
 
 #include <YamlCheck.H>
 #include <EXPException.H>
@@ -6,6 +9,7 @@
 #include <DiskModels.H>
 #include <exputils.H>
 #include <gaussQ.H>
+#include <libvars.H>
 
 #ifdef HAVE_FE_ENABLE
 #include <cfenv>
@@ -212,8 +216,21 @@ namespace BasisClasses
     for (auto & v : dlegs ) v.resize(lmax+1, lmax+1);
     for (auto & v : d2legs) v.resize(lmax+1, lmax+1);
 
+    radt.resize(nthrds);
+    rsum.resize(nthrds);
+
+    for (auto & v : radt) v.resize(nmax, 3);
+    for (auto & v : rsum) v.resize((lmax+1)*(lmax+1), 3);
+
     expcoef.resize((lmax+1)*(lmax+1), nmax);
     expcoef.setZero();
+
+    // Per-thread coefficient tables for threaded accumulation
+    //
+    expcoef0.resize(nthrds);
+    for (auto & v : expcoef0) v.setZero((lmax+1)*(lmax+1), nmax);
+    used0.resize(nthrds, 0);
+    mass0.resize(nthrds, 0.0);
       
     work.resize(nmax);
       
@@ -324,6 +341,9 @@ namespace BasisClasses
   void Spherical::reset_coefs(void)
   {
     if (expcoef.rows()>0 && expcoef.cols()>0) expcoef.setZero();
+    for (auto & v : expcoef0) v.setZero();
+    std::fill(used0.begin(), used0.end(), 0);
+    std::fill(mass0.begin(), mass0.end(), 0.0);
     totalMass = 0.0;
     used = 0;
   }
@@ -441,8 +461,8 @@ namespace BasisClasses
     
     if (r < rmin or r > rmax) return;
     
-    used++;
-    totalMass += mass;
+    used0[tid]++;
+    mass0[tid] += mass;
     
     get_pot(potd[tid], rs);
     
@@ -461,7 +481,7 @@ namespace BasisClasses
 	  fac = factorial(l, m) * legs[tid](l, m);
 	  for (int n=0; n<nmax; n++) {
 	    fac4 = potd[tid](l, n)*fac;
-	    expcoef(loffset+moffset, n) += fac4 * norm * mass;
+	    expcoef0[tid](loffset+moffset, n) += fac4 * norm * mass;
 	  }
 	  
 	  moffset++;
@@ -472,8 +492,8 @@ namespace BasisClasses
 	  fac2 = fac*sin(phi*m);
 	  for (int n=0; n<nmax; n++) {
 	    fac4 = potd[tid](l, n);
-	    expcoef(loffset+moffset  , n) += fac1 * fac4 * norm * mass;
-	    expcoef(loffset+moffset+1, n) += fac2 * fac4 * norm * mass;
+	    expcoef0[tid](loffset+moffset  , n) += fac1 * fac4 * norm * mass;
+	    expcoef0[tid](loffset+moffset+1, n) += fac2 * fac4 * norm * mass;
 	  }
 	  
 	  moffset+=2;
@@ -485,6 +505,17 @@ namespace BasisClasses
   
   void Spherical::make_coefs()
   {
+    // Sum the per-thread tables in thread order
+    //
+    for (size_t t=0; t<expcoef0.size(); t++) {
+      expcoef   += expcoef0[t];
+      used      += used0[t];
+      totalMass += mass0[t];
+      expcoef0[t].setZero();
+      used0[t] = 0;
+      mass0[t] = 0.0;
+    }
+
     if (use_mpi) {
       
       MPI_Allreduce(MPI_IN_PLACE, &used, 1, MPI_INT,
@@ -499,16 +530,12 @@ namespace BasisClasses
     }
   }
   
-  std::vector<double>
-  Spherical::sph_eval(double r, double costh, double phi)
+  void Spherical::sph_fields(double r, double costh, double phi, double* v)
   {
     // Get thread id
     int tid = omp_get_thread_num();
 
     double fac1, cosm, sinm;
-    double sinth = -sqrt(fabs(1.0 - costh*costh));
-    
-    fac1 = factorial(0, 0);
     
     get_dens (dend[tid], r/scale);
     get_pot  (potd[tid], r/scale);
@@ -516,6 +543,27 @@ namespace BasisClasses
     
     legendre_R(lmax, costh, legs[tid], dlegs[tid]);
     
+    // The radial sums for every m at fixed l are one product of the
+    // coefficient rows with the radial table, stored with density,
+    // potential and force as contiguous columns
+    //
+    auto & tab = radt[tid];
+    auto & sum = rsum[tid];
+
+    auto radial = [&](int l, int loffset, int nrow, int n0, int nn)
+    {
+      tab.col(0) = dend[tid].row(l).transpose();
+      tab.col(1) = potd[tid].row(l).transpose();
+      tab.col(2) = dpot[tid].row(l).transpose();
+
+      sum.middleRows(loffset, nrow).noalias() =
+	expcoef.block(loffset, n0, nrow, nn) * tab.middleRows(n0, nn);
+    };
+
+    int n0 = std::max<int>(0, N1);
+    int nn = std::min<int>(nmax-1, N2) - n0 + 1;
+    if (nn<0) nn = 0;
+
     double den0, pot0, potr;
 
     if (NO_L0) {
@@ -523,9 +571,11 @@ namespace BasisClasses
       pot0 = 0.0;
       potr = 0.0;
     } else {
-      den0 = fac1 * expcoef.row(0).dot(dend[tid].row(0));
-      pot0 = fac1 * expcoef.row(0).dot(potd[tid].row(0));
-      potr = fac1 * expcoef.row(0).dot(dpot[tid].row(0));
+      radial(0, 0, 1, 0, nmax);
+      fac1 = factorial(0, 0);
+      den0 = fac1 * sum(0, 0);
+      pot0 = fac1 * sum(0, 1);
+      potr = fac1 * sum(0, 2);
     }
 
     double den1 = 0.0;
@@ -542,25 +592,22 @@ namespace BasisClasses
       // No l=1
       if (NO_L1 and l==1) continue;
       
+      radial(l, loffset, 2*l+1, n0, nn);
+
       // M loop
       for (int m=0, moffset=0; m<=l; m++) {
 	
 	if (M0_only and m) continue;
 	if (EVEN_M and m%2) continue;
 	
+	int k = loffset + moffset;
+
 	fac1 = factorial(l, m);
 	if (m==0) {
-	  double sumR=0.0, sumP=0.0, sumD=0.0;
-	  for (int n=std::max<int>(0, N1); n<=std::min<int>(nmax-1, N2); n++) {
-	    sumR += expcoef(loffset+moffset, n) * dend[tid](l, n);
-	    sumP += expcoef(loffset+moffset, n) * potd[tid](l, n);
-	    sumD += expcoef(loffset+moffset, n) * dpot[tid](l, n);
-	  }
-	  
-	  den1 += fac1*legs[tid] (l, m) * sumR;
-	  pot1 += fac1*legs[tid] (l, m) * sumP;
-	  potr += fac1*legs[tid] (l, m) * sumD;
-	  pott += fac1*dlegs[tid](l, m) * sumP;
+	  den1 += fac1*legs[tid] (l, m) * sum(k, 0);
+	  pot1 += fac1*legs[tid] (l, m) * sum(k, 1);
+	  potr += fac1*legs[tid] (l, m) * sum(k, 2);
+	  pott += fac1*dlegs[tid](l, m) * sum(k, 1);
 	  
 	  moffset++;
 	}
@@ -568,22 +615,11 @@ namespace BasisClasses
 	  cosm = cos(phi*m);
 	  sinm = sin(phi*m);
 	  
-	  double sumR0=0.0, sumP0=0.0, sumD0=0.0;
-	  double sumR1=0.0, sumP1=0.0, sumD1=0.0;
-	  for (int n=std::max<int>(0, N1); n<=std::min<int>(nmax-1, N2); n++) {
-	    sumR0 += expcoef(loffset+moffset+0, n) * dend[tid](l, n);
-	    sumP0 += expcoef(loffset+moffset+0, n) * potd[tid](l, n);
-	    sumD0 += expcoef(loffset+moffset+0, n) * dpot[tid](l, n);
-	    sumR1 += expcoef(loffset+moffset+1, n) * dend[tid](l, n);
-	    sumP1 += expcoef(loffset+moffset+1, n) * potd[tid](l, n);
-	    sumD1 += expcoef(loffset+moffset+1, n) * dpot[tid](l, n);
-	  }
-	  
-	  den1 += fac1 * legs[tid] (l, m) *  ( sumR0*cosm + sumR1*sinm );
-	  pot1 += fac1 * legs[tid] (l, m) *  ( sumP0*cosm + sumP1*sinm );
-	  potr += fac1 * legs[tid] (l, m) *  ( sumD0*cosm + sumD1*sinm );
-	  pott += fac1 * dlegs[tid](l, m) *  ( sumP0*cosm + sumP1*sinm );
-	  potp += fac1 * legs[tid] (l, m) *  (-sumP0*sinm + sumP1*cosm ) * m;
+	  den1 += fac1 * legs[tid] (l, m) *  ( sum(k, 0)*cosm + sum(k+1, 0)*sinm );
+	  pot1 += fac1 * legs[tid] (l, m) *  ( sum(k, 1)*cosm + sum(k+1, 1)*sinm );
+	  potr += fac1 * legs[tid] (l, m) *  ( sum(k, 2)*cosm + sum(k+1, 2)*sinm );
+	  pott += fac1 * dlegs[tid](l, m) *  ( sum(k, 1)*cosm + sum(k+1, 1)*sinm );
+	  potp += fac1 * legs[tid] (l, m) *  (-sum(k, 1)*sinm + sum(k+1, 1)*cosm ) * m;
 	  
 	  moffset +=2;
 	}
@@ -593,21 +629,28 @@ namespace BasisClasses
     double densfac = 1.0/(scale*scale*scale) * 0.25/M_PI;
     double potlfac = 1.0/scale;
     
-    return
-      {den0 * densfac,		// 0
-       den1 * densfac,		// 1
-       (den0 + den1) * densfac,	// 2
-       pot0 * potlfac,		// 3
-       pot1 * potlfac,		// 4
-       (pot0 + pot1) * potlfac,	// 5
-       potr * (-potlfac)/scale,	// 6
-       pott * (-potlfac),	// 7
-       potp * (-potlfac)};	// 8
-    //         ^
-    //         |
+    v[0] = den0 * densfac;
+    v[1] = den1 * densfac;
+    v[2] = (den0 + den1) * densfac;
+    v[3] = pot0 * potlfac;
+    v[4] = pot1 * potlfac;
+    v[5] = (pot0 + pot1) * potlfac;
+    v[6] = potr * (-potlfac)/scale;
+    v[7] = pott * (-potlfac);
+    v[8] = potp * (-potlfac);
+    //       ^
+    //       |
     // Return force not potential gradient
   }
 
+  std::vector<double>
+  Spherical::sph_eval(double r, double costh, double phi)
+  {
+    std::vector<double> ret(9);
+    sph_fields(r, costh, phi, ret.data());
+    return ret;
+  }
+
 
   std::vector<double>
   Spherical::cyl_eval(double R, double z, double phi)
@@ -625,19 +668,31 @@ namespace BasisClasses
 
 
   // Evaluate in cartesian coordinates
-  std::vector<double>
-  Spherical::crt_eval
-  (double x, double y, double z)
+  void Spherical::crt_fields(double x, double y, double z, double* v)
   {
     double R = sqrt(x*x + y*y);
     double phi = atan2(y, x);
 
-    auto v = cyl_eval(R, z, phi);
+    double r = sqrt(R*R + z*z) + 1.0e-18;
+    double costh = z/r, sinth = R/r;
 
-    double tpotx = v[6]*x/R - v[8]*y/R ;
-    double tpoty = v[6]*y/R + v[8]*x/R ;
-    
-    return {v[0], v[1], v[2], v[3], v[4], v[5], tpotx, tpoty, v[7]};
+    sph_fields(r, costh, phi, v);
+
+    double potR = v[6]*sinth + v[7]*costh;
+    double potz = v[6]*costh - v[7]*sinth;
+
+    v[6] = potR*x/R - v[8]*y/R ;
+    v[7] = potR*y/R + v[8]*x/R ;
+    v[8] = potz;
+  }
+
+  std::vector<double>
+  Spherical::crt_eval
+  (double x, double y, double z)
+  {
+    std::vector<double> ret(9);
+    crt_fields(x, y, z, ret.data());
+    return ret;
   }
   
 
@@ -897,6 +952,7 @@ namespace BasisClasses
     "ignore",
     "deproject",
     "logr",
+    "packtables",
     "pcavar",
     "pcaeof",
     "pcavtk",
@@ -1046,6 +1102,7 @@ namespace BasisClasses
     tnum        = 80;
     ashift      = 0.0;
     logarithmic = false;
+    packtables  = false;
     density     = true;
     EVEN_M      = false;
     cmapR       = 1;
@@ -1116,6 +1173,7 @@ namespace BasisClasses
 
       if (conf["ashift"    ])     ashift  = conf["ashift"    ].as<double>();
       if (conf["logr"      ]) logarithmic = conf["logr"      ].as<bool>();
+      if (conf["packtables"])  packtables = conf["packtables"].as<bool>();
       if (conf["EVEN_M"    ])     EVEN_M  = conf["EVEN_M"    ].as<bool>();
       if (conf["cmapr"     ])      cmapR  = conf["cmapr"     ].as<int>();
       if (conf["cmapz"     ])      cmapZ  = conf["cmapz"     ].as<int>();
@@ -1182,6 +1240,7 @@ namespace BasisClasses
     EmpCylSL::CMAPR       = cmapR;
     EmpCylSL::CMAPZ       = cmapZ;
     EmpCylSL::logarithmic = logarithmic;
+    EmpCylSL::packed_tables = packtables;
     EmpCylSL::VFLAG       = vflag;
     
     // Check for non-null cache file name.  This must be specified
@@ -1196,10 +1255,12 @@ namespace BasisClasses
 	 "reading a previously generated basis cache\n");
     }
 
-    // Make the empirical orthogonal basis instance
+    // Make the empirical orthogonal basis instance with a
+    // per-thread accumulator for each thread of the OpenMP team
     //
     sl = std::make_shared<EmpCylSL>
-      (nmaxfid, lmaxfid, mmax, nmax, acyl, hcyl, ncylodd, cachename);
+      (nmaxfid, lmaxfid, mmax, nmax, acyl, hcyl, ncylodd, cachename,
+       omp_get_max_threads());
     
     // Set azimuthal harmonic order restriction?
     //
@@ -1345,8 +1406,12 @@ namespace BasisClasses
        tpotl0, tpotl-tpotl0, tpotl, tpotr, tpott, tpotp};
   }
   
-  // Evaluate in cartesian coordinates
-  std::vector<double> Cylindrical::crt_eval(double x, double y, double z)
+  // Evaluate in cartesian coordinates.  EmpCylSL interpolates each
+  // (m, n) term from its (R, z) tables rather than evaluating radial
+  // functions, so there is no radial block product as in Spherical or
+  // FlatDisk; with 'packtables' the tables for the four neighboring
+  // grid nodes are read from contiguous blocks instead.
+  void Cylindrical::crt_fields(double x, double y, double z, double* v)
   {
     double R = sqrt(x*x + y*y);
     double phi = atan2(y, x);
@@ -1357,12 +1422,22 @@ namespace BasisClasses
     
     tdens = sl->accumulated_dens_eval(R, z, phi, tdens0);
 
-    double tpotx = tpotR*x/R - tpotp*y/R ;
-    double tpoty = tpotR*y/R + tpotp*x/R ;
+    v[0] = tdens0;
+    v[1] = tdens - tdens0;
+    v[2] = tdens;
+    v[3] = tpotl0;
+    v[4] = tpotl - tpotl0;
+    v[5] = tpotl;
+    v[6] = tpotR*x/R - tpotp*y/R ;
+    v[7] = tpotR*y/R + tpotp*x/R ;
+    v[8] = tpotz;
+  }
 
-    return
-      {tdens0, tdens - tdens0, tdens,
-       tpotl0, tpotl - tpotl0, tpotl, tpotx, tpoty, tpotz};
+  std::vector<double> Cylindrical::crt_eval(double x, double y, double z)
+  {
+    std::vector<double> ret(9);
+    crt_fields(x, y, z, ret.data());
+    return ret;
   }
   
   // Evaluate in cylindrical coordinates
@@ -1391,9 +1466,14 @@ namespace BasisClasses
   {
     double R   = sqrt(x*x + y*y);
     double phi = atan2(y, x);
-    sl->accumulate(R, z, phi, mass, 0, 0);
+    sl->accumulate(R, z, phi, mass, 0, omp_get_thread_num());
   }
   
+  int Cylindrical::accum_threads()
+  {
+    return sl->get_nthrds();
+  }
+
   void Cylindrical::reset_coefs(void)
   {
     sl->setup_accumulation();
@@ -1660,8 +1740,21 @@ namespace BasisClasses
     for (auto & v : potZ) v.resize(mmax+1, nmax);
     for (auto & v : dend) v.resize(mmax+1, nmax);
 
+    radt.resize(nthrds);
+    rsum.resize(nthrds);
+
+    for (auto & v : radt) v.resize(nmax, 4);
+    for (auto & v : rsum) v.resize(2*mmax+1, 4);
+
     expcoef.resize(2*mmax+1, nmax);
     expcoef.setZero();
+
+    // Per-thread coefficient tables for threaded accumulation
+    //
+    expcoef0.resize(nthrds);
+    for (auto & v : expcoef0) v.setZero(2*mmax+1, nmax);
+    used0.resize(nthrds, 0);
+    mass0.resize(nthrds, 0.0);
       
     work.resize(nmax);
       
@@ -1675,6 +1768,9 @@ namespace BasisClasses
   void FlatDisk::reset_coefs(void)
   {
     if (expcoef.rows()>0 && expcoef.cols()>0) expcoef.setZero();
+    for (auto & v : expcoef0) v.setZero();
+    std::fill(used0.begin(), used0.end(), 0);
+    std::fill(mass0.begin(), mass0.end(), 0.0);
     totalMass = 0.0;
     used = 0;
   }
@@ -1767,15 +1863,15 @@ namespace BasisClasses
     //======================
     
     double R2 = x*x + y*y;
-    double R  = sqrt(R);
+    double R  = sqrt(R2);
     
     // Get thread id
     int tid = omp_get_thread_num();
 
     if (R < ortho->getRtable() and fabs(z) < ortho->getRtable()) {
     
-      used++;
-      totalMass += mass;
+      used0[tid]++;
+      mass0[tid] += mass;
     
       double phi = atan2(y, x);
 
@@ -1786,7 +1882,7 @@ namespace BasisClasses
 	
 	if (m==0) {
 	  for (int n=0; n<nmax; n++) {
-	    expcoef(moffset, n) += potd[tid](m, n)* mass * norm0;
+	    expcoef0[tid](moffset, n) += potd[tid](m, n)* mass * norm0;
 	  }
 	  
 	  moffset++;
@@ -1795,8 +1891,8 @@ namespace BasisClasses
 	  double ccos = cos(phi*m);
 	  double ssin = sin(phi*m);
 	  for (int n=0; n<nmax; n++) {
-	    expcoef(moffset  , n) += ccos * potd[tid](m, n) * mass * norm1;
-	    expcoef(moffset+1, n) += ssin * potd[tid](m, n) * mass * norm1;
+	    expcoef0[tid](moffset  , n) += ccos * potd[tid](m, n) * mass * norm1;
+	    expcoef0[tid](moffset+1, n) += ssin * potd[tid](m, n) * mass * norm1;
 	  }
 	  moffset+=2;
 	}
@@ -1807,6 +1903,17 @@ namespace BasisClasses
   
   void FlatDisk::make_coefs()
   {
+    // Sum the per-thread tables in thread order
+    //
+    for (size_t t=0; t<expcoef0.size(); t++) {
+      expcoef   += expcoef0[t];
+      used      += used0[t];
+      totalMass += mass0[t];
+      expcoef0[t].setZero();
+      used0[t] = 0;
+      mass0[t] = 0.0;
+    }
+
     if (use_mpi) {
       
       MPI_Allreduce(MPI_IN_PLACE, &used, 1, MPI_INT,
@@ -1821,7 +1928,7 @@ namespace BasisClasses
     }
   }
   
-  std::vector<double>FlatDisk::cyl_eval(double R, double z, double phi)
+  void FlatDisk::cyl_fields(double R, double z, double phi, double* v)
   {
     // Get thread id
     int tid = omp_get_thread_num();
@@ -1840,7 +1947,10 @@ namespace BasisClasses
       rpot = -totalMass*R/(r*r2 + 10.0*std::numeric_limits<double>::min());
       zpot = -totalMass*z/(r*r2 + 10.0*std::numeric_limits<double>::min());
       
-      return {den0, den1, den0+den1, pot0, pot1, pot0+pot1, rpot, zpot, ppot};
+      v[0] = den0; v[1] = den1; v[2] = den0 + den1;
+      v[3] = pot0; v[4] = pot1; v[5] = pot0 + pot1;
+      v[6] = rpot; v[7] = zpot; v[8] = ppot;
+      return;
     }
 
     // Get the basis fields
@@ -1850,6 +1960,17 @@ namespace BasisClasses
     ortho->get_rforce (potR[tid],  R, z);
     ortho->get_zforce (potZ[tid],  R, z);
     
+    // The radial sums for the cosine and sine terms at fixed m are
+    // one product of the coefficient rows with the radial table,
+    // stored with density, potential and forces as contiguous columns
+    //
+    auto & tab = radt[tid];
+    auto & sum = rsum[tid];
+
+    int n0 = std::max<int>(0, N1);
+    int nn = std::min<int>(nmax-1, N2) - n0 + 1;
+    if (nn<0) nn = 0;
+
     // m loop
     //
     for (int m=0, moffset=0; m<=mmax; m++) {
@@ -1859,51 +1980,32 @@ namespace BasisClasses
       if (EVEN_M and m/2*2 != m) { moffset += 2; continue; }
       if (m>0 and M0_only)       break;
 
+      int nrow = m ? 2 : 1;
+
+      tab.col(0) = dend[tid].row(m).transpose();
+      tab.col(1) = potd[tid].row(m).transpose();
+      tab.col(2) = potR[tid].row(m).transpose();
+      tab.col(3) = potZ[tid].row(m).transpose();
+
+      sum.middleRows(moffset, nrow).noalias() =
+	expcoef.block(moffset, n0, nrow, nn) * tab.middleRows(n0, nn);
+
       if (m==0) {
-	for (int n=std::max<int>(0, N1); n<=std::min<int>(nmax-1, N2); n++) {
-	  den0 += expcoef(0, n) * dend[tid](0, n) * norm0;
-	  pot0 += expcoef(0, n) * potd[tid](0, n) * norm0;
-	  rpot += expcoef(0, n) * potR[tid](0, n) * norm0;
-	  zpot += expcoef(0, n) * potZ[tid](0, n) * norm0;
-	}
+	den0 += sum(0, 0) * norm0;
+	pot0 += sum(0, 1) * norm0;
+	rpot += sum(0, 2) * norm0;
+	zpot += sum(0, 3) * norm0;
 	
 	moffset++;
       } else {
 	double cosm = cos(phi*m), sinm = sin(phi*m);
-	double vc, vs;
-
-	vc = vs = 0.0;
-	for (int n=std::max<int>(0, N1); n<=std::min<int>(nmax-1, N2); n++) {
-	  vc += expcoef(moffset+0, n) * dend[tid](m, n);
-	  vs += expcoef(moffset+1, n) * dend[tid](m, n);
-	}
-	
-	den1 += (vc*cosm + vs*sinm) * norm1;
-      
-	vc = vs = 0.0;
-	for (int n=std::max<int>(0, N1); n<=std::min<int>(nmax-1, N2); n++) {
-	  vc += expcoef(moffset+0, n) * potd[tid](m, n);
-	  vs += expcoef(moffset+1, n) * potd[tid](m, n);
-	}
-	
-	pot1 += ( vc*cosm + vs*sinm) * norm1;
-	ppot += (-vc*sinm + vs*cosm) * m * norm1;
-
-	vc = vs = 0.0;
-	for (int n=std::max<int>(0, N1); n<=std::min<int>(nmax-1, N2); n++) {
-	  vc += expcoef(moffset+0, n) * potR[tid](m, n);
-	  vs += expcoef(moffset+1, n) * potR[tid](m, n);
-	}
+	int k = moffset;
 
-	rpot += (vc*cosm + vs*sinm) * norm1;
-	
-	vc = vs = 0.0;
-	for (int n=std::max<int>(0, N1); n<=std::min<int>(nmax-1, N2); n++) {
-	  vc += expcoef(moffset+0, n) * potZ[tid](m, n);
-	  vs += expcoef(moffset+1, n) * potZ[tid](m, n);
-	}
-
-	zpot += (vc*cosm + vs*sinm) * norm1;
+	den1 += ( sum(k, 0)*cosm + sum(k+1, 0)*sinm) * norm1;
+	pot1 += ( sum(k, 1)*cosm + sum(k+1, 1)*sinm) * norm1;
+	ppot += (-sum(k, 1)*sinm + sum(k+1, 1)*cosm) * m * norm1;
+	rpot += ( sum(k, 2)*cosm + sum(k+1, 2)*sinm) * norm1;
+	zpot += ( sum(k, 3)*cosm + sum(k+1, 3)*sinm) * norm1;
 
 	moffset +=2;
       }
@@ -1917,7 +2019,16 @@ namespace BasisClasses
     zpot *= -1.0;
     ppot *= -1.0;
 
-    return {den0, den1, den0+den1, pot0, pot1, pot0+pot1, rpot, zpot, ppot};
+    v[0] = den0; v[1] = den1; v[2] = den0 + den1;
+    v[3] = pot0; v[4] = pot1; v[5] = pot0 + pot1;
+    v[6] = rpot; v[7] = zpot; v[8] = ppot;
+  }
+
+  std::vector<double>FlatDisk::cyl_eval(double R, double z, double phi)
+  {
+    std::vector<double> ret(9);
+    cyl_fields(R, z, phi, ret.data());
+    return ret;
   }
 
 
@@ -1938,19 +2049,28 @@ namespace BasisClasses
     return {v[0], v[1], v[2], v[3], v[4], v[5], potr, pott, v[8]};
   }
 
-  std::vector<double> FlatDisk::crt_eval(double x, double y, double z)
+  void FlatDisk::crt_fields(double x, double y, double z, double* v)
   {
     // Cylindrical coords from Cartesian
     //
     double R = sqrt(x*x + y*y) + 1.0e-18;
     double phi = atan2(y, x);
 
-    auto v = cyl_eval(R, z, phi);
+    cyl_fields(R, z, phi, v);
 
-    double potx = v[4]*x/R - v[8]*y/R;
-    double poty = v[4]*y/R + v[8]*x/R;
+    double potx = v[6]*x/R - v[8]*y/R;
+    double poty = v[6]*y/R + v[8]*x/R;
 
-    return {v[0], v[1], v[2], v[3], v[4], v[5], potx, poty, v[7]};
+    v[8] = v[7];
+    v[6] = potx;
+    v[7] = poty;
+  }
+
+  std::vector<double> FlatDisk::crt_eval(double x, double y, double z)
+  {
+    std::vector<double> ret(9);
+    crt_fields(x, y, z, ret.data());
+    return ret;
   }
 
   std::vector<Eigen::MatrixXd> FlatDisk::orthoCheck()
@@ -2106,6 +2226,26 @@ namespace BasisClasses
     //
     expcoef.resize(imx, imy, imz);
     expcoef.setZero();
+
+    // Per-thread coefficient tables for threaded accumulation
+    //
+    expcoef0.resize(nthrds);
+    for (auto & v : expcoef0) {
+      v.resize(imx, imy, imz);
+      v.setZero();
+    }
+    used0.resize(nthrds, 0);
+
+    // Per-thread vertical basis storage for evaluation
+    //
+    vpotT.resize(nthrds);
+    vfrcT.resize(nthrds);
+    vdenT.resize(nthrds);
+    for (int t=0; t<nthrds; t++) {
+      vpotT[t].resize(nmaxz);
+      vfrcT[t].resize(nmaxz);
+      vdenT[t].resize(nmaxz);
+    }
       
     used = 0;
 
@@ -2117,6 +2257,8 @@ namespace BasisClasses
   void Slab::reset_coefs(void)
   {
     expcoef.setZero();
+    for (auto & v : expcoef0) v.setZero();
+    std::fill(used0.begin(), used0.end(), 0);
     totalMass = 0.0;
     used = 0;
   }
@@ -2180,7 +2322,10 @@ namespace BasisClasses
     else
       y -= std::floor( y);
     
-    used++;
+    // Get thread id
+    int tid = omp_get_thread_num();
+
+    used0[tid]++;
 
     // Storage for basis evaluation
     Eigen::VectorXd zpot(nmaxz);
@@ -2225,7 +2370,7 @@ namespace BasisClasses
 	                       // +--- density in orthogonal series
                                // |    is 4.0*M_PI rho
                                // v
-	  expcoef(ix, iy, iz) += -4.0*M_PI*mass*facx*facy*zpot[iz];
+	  expcoef0[tid](ix, iy, iz) += -4.0*M_PI*mass*facx*facy*zpot[iz];
 	}
       }
     }
@@ -2233,6 +2378,15 @@ namespace BasisClasses
   
   void Slab::make_coefs()
   {
+    // Sum the per-thread tables in thread order
+    //
+    for (size_t t=0; t<expcoef0.size(); t++) {
+      expcoef += expcoef0[t];
+      used    += used0[t];
+      expcoef0[t].setZero();
+      used0[t] = 0;
+    }
+
     if (use_mpi) {
       
       MPI_Allreduce(MPI_IN_PLACE, &used, 1, MPI_INT,
@@ -2268,7 +2422,12 @@ namespace BasisClasses
     std::complex<double> startx = exp(-static_cast<double>(nmaxx)*kfac*x);
     std::complex<double> starty = exp(-static_cast<double>(nmaxy)*kfac*y);
     
-    Eigen::VectorXd vpot(nmaxz), vfrc(nmaxz), vden(nmaxz);
+    // Vertical basis storage for this thread
+    //
+    int tid = omp_get_thread_num();
+    auto & vpot = vpotT[tid];
+    auto & vfrc = vfrcT[tid];
+    auto & vden = vdenT[tid];
 
     for (facx=startx, ix=0; ix<imx; ix++, facx*=stepx) {
       
@@ -2327,14 +2486,20 @@ namespace BasisClasses
 
 
 
-  std::vector<double> Slab::crt_eval(double x, double y, double z)
+  void Slab::crt_fields(double x, double y, double z, double* v)
   {
-    // Get thread id
-    int tid = omp_get_thread_num();
-
     auto [pot, den, frcx, frcy, frcz] = eval(x, y, z);
 
-    return {0, den, den, 0, pot, pot, frcx, frcy, frcz};
+    v[0] = 0;    v[1] = den;  v[2] = den;
+    v[3] = 0;    v[4] = pot;  v[5] = pot;
+    v[6] = frcx; v[7] = frcy; v[8] = frcz;
+  }
+
+  std::vector<double> Slab::crt_eval(double x, double y, double z)
+  {
+    std::vector<double> ret(9);
+    crt_fields(x, y, z, ret.data());
+    return ret;
   }
 
   std::vector<double> Slab::cyl_eval(double R, double z, double phi)
@@ -2538,6 +2703,14 @@ namespace BasisClasses
 
     expcoef.resize(2*nmaxx+1, 2*nmaxy+1, 2*nmaxz+1);
     expcoef.setZero();
+
+    // Per-thread coefficient tables for threaded accumulation
+    //
+    expcoef0.resize(nthrds);
+    for (auto & v : expcoef0) {
+      v.resize(2*nmaxx+1, 2*nmaxy+1, 2*nmaxz+1);
+      v.setZero();
+    }
       
     used = 0;
 
@@ -2549,6 +2722,7 @@ namespace BasisClasses
   void Cube::reset_coefs(void)
   {
     expcoef.setZero();
+    for (auto & v : expcoef0) v.setZero();
     totalMass = 0.0;
     used = 0;
   }
@@ -2601,6 +2775,9 @@ namespace BasisClasses
 
   void Cube::accumulate(double x, double y, double z, double mass)
   {
+    // Get thread id
+    int tid = omp_get_thread_num();
+
     // Truncate to cube with sides in [0,1]
     if (x<0.0)
       x += std::floor(-x) + 1.0;
@@ -2645,7 +2822,7 @@ namespace BasisClasses
 	  // Normalization
 	  double norm = 1.0/sqrt(M_PI*(ii*ii + jj*jj + kk*kk));;
 
-	  expcoef(ix, iy, iz) += - mass * curr(0)*curr(1)*curr(2) * norm;
+	  expcoef0[tid](ix, iy, iz) += - mass * curr(0)*curr(1)*curr(2) * norm;
 	}
       }
     }
@@ -2653,6 +2830,13 @@ namespace BasisClasses
   
   void Cube::make_coefs()
   {
+    // Sum the per-thread tables in thread order
+    //
+    for (auto & v : expcoef0) {
+      expcoef += v;
+      v.setZero();
+    }
+
     if (use_mpi) {
       
       MPI_Allreduce(MPI_IN_PLACE, &used, 1, MPI_INT,
@@ -2663,11 +2847,8 @@ namespace BasisClasses
     }
   }
   
-  std::vector<double> Cube::crt_eval(double x, double y, double z)
+  void Cube::crt_fields(double x, double y, double z, double* v)
   {
-    // Get thread id
-    int tid = omp_get_thread_num();
-
     // Position vector
     Eigen::Vector3d pos {x, y, z};
 
@@ -2677,11 +2858,16 @@ namespace BasisClasses
 
     auto frc = ortho->get_force(expcoef, pos);
     
-    double frcx = -frc(0).real();
-    double frcy = -frc(1).real();
-    double frcz = -frc(2).real();
+    v[0] = 0;              v[1] = den1;           v[2] = den1;
+    v[3] = 0;              v[4] = pot1;           v[5] = pot1;
+    v[6] = -frc(0).real(); v[7] = -frc(1).real(); v[8] = -frc(2).real();
+  }
 
-    return {0, den1, den1, 0, pot1, pot1, frcx, frcy, frcz};
+  std::vector<double> Cube::crt_eval(double x, double y, double z)
+  {
+    std::vector<double> ret(9);
+    crt_fields(x, y, z, ret.data());
+    return ret;
   }
 
   std::vector<double> Cube::cyl_eval(double R, double z, double phi)
@@ -2784,31 +2970,72 @@ namespace BasisClasses
     //
     if (addCenter) coef->ctr = ctr;
 
-    std::vector<double> pp(3), vv(3);
+    // Particle batches are filled by a reader thread, applying the
+    // selector, while the OpenMP team accumulates the previous batch
+    // into per-thread coefficient tables.  The tables are summed by
+    // make_coefs().
+    //
+    struct Batch
+    {
+      std::vector<double> mass, pos;
+    } cur, nxt;
 
-    reset_coefs();
-    for (auto p=reader->firstParticle(); p!=0; p=reader->nextParticle()) {
+    auto p = reader->firstParticle();
+
+    auto fill = [&](Batch& b)
+    {
+      std::vector<double> pp(3), vv(3);
+
+      b.mass.clear();
+      b.pos .clear();
 
-      bool use = false;
+      for (; p!=0 and b.mass.size()<batchSize; p=reader->nextParticle()) {
+
+	bool use = false;
       
-      if (ftor) {
-	pp.assign(p->pos, p->pos+3);
-	vv.assign(p->vel, p->vel+3);
-	use = ftor(p->mass, pp, vv, p->indx);
-      } else {
-	use = true;
+	if (ftor) {
+	  pp.assign(p->pos, p->pos+3);
+	  vv.assign(p->vel, p->vel+3);
+	  use = ftor(p->mass, pp, vv, p->indx);
+	} else {
+	  use = true;
+	}
+
+	if (use) {
+	  b.mass.push_back(p->mass);
+	  for (int k=0; k<3; k++) b.pos.push_back(p->pos[k]-ctr[k]);
+	}
       }
+    };
+
+    reset_coefs();
 
-      if (use) accumulate(p->pos[0]-ctr[0],
-			  p->pos[1]-ctr[1],
-			  p->pos[2]-ctr[2],
-			  p->mass);
+    fill(cur);
+    while (cur.mass.size()) {
+      auto next = std::async(std::launch::async, fill, std::ref(nxt));
+      accumulate_batch(cur.mass, cur.pos);
+      next.get();
+      std::swap(cur, nxt);
     }
+
     make_coefs();
     load_coefs(coef, reader->CurrentTime());
     return coef;
   }
 
+  // Accumulate a batch of particles in parallel
+  void BiorthBasis::accumulate_batch(const std::vector<double>& mass,
+				     const std::vector<double>& pos)
+  {
+    int nthrds = std::max<int>(1, std::min<int>(accum_threads(),
+						omp_get_max_threads()));
+    int number = mass.size();
+
+#pragma omp parallel for schedule(static) num_threads(nthrds)
+    for (int n=0; n<number; n++)
+      accumulate(pos[3*n+0], pos[3*n+1], pos[3*n+2], mass[n]);
+  }
+
   // Generate coefficients from a phase-space table
   void BiorthBasis::initFromArray(std::vector<double> ctr)
   {
@@ -2889,6 +3116,16 @@ namespace BasisClasses
 
     std::vector<double> p1(3), v1(3, 0);
 
+    // Selected particles are accumulated in parallel batches
+    //
+    std::vector<double> bmass, bpos;
+    auto flush = [&]()
+    {
+      accumulate_batch(bmass, bpos);
+      bmass.clear();
+      bpos .clear();
+    };
+
     if (PosVelRows) {
       if (p.rows()<3) {
 	std::ostringstream msg;
@@ -2910,9 +3147,11 @@ namespace BasisClasses
 	  }
 	  coefindx++;
 	  
-	  if (use) accumulate(p(0, n)-coefctr[0],
-			      p(1, n)-coefctr[1],
-			      p(2, n)-coefctr[2], m(n));
+	  if (use) {
+	    bmass.push_back(m(n));
+	    for (int k=0; k<3; k++) bpos.push_back(p(k, n)-coefctr[k]);
+	    if (bmass.size()==batchSize) flush();
+	  }
 	}
       }
       
@@ -2938,12 +3177,16 @@ namespace BasisClasses
 	  }
 	  coefindx++;
 	  
-	  if (use) accumulate(p(n, 0)-coefctr[0],
-			      p(n, 1)-coefctr[1],
-			      p(n, 2)-coefctr[2], m(n));
+	  if (use) {
+	    bmass.push_back(m(n));
+	    for (int k=0; k<3; k++) bpos.push_back(p(n, k)-coefctr[k]);
+	    if (bmass.size()==batchSize) flush();
+	  }
 	}
       }
     }
+
+    flush();
   }
 
   // Generate coefficients from the accumulated array values
@@ -2965,6 +3208,37 @@ namespace BasisClasses
     return makeFromArray(time);
   }
 
+  void BiorthBasis::crt_fields(double x, double y, double z, double* v)
+  {
+    auto ret = crt_eval(x, y, z);
+    std::copy(ret.begin(), ret.end(), v);
+  }
+
+  int BiorthBasis::eval_threads()
+  {
+    return omp_get_max_threads();
+  }
+
+  // Evaluate each point into its own row of the output array.  The
+  // evaluators use per-thread scratch indexed by the OpenMP thread
+  // id, which was sized when the basis was made, so the team is
+  // limited to the scratch size if the thread count has since been
+  // raised.
+  //
+  void BiorthBasis::getFieldsBatch(const Eigen::Ref<const RowMatrixXd>& pos,
+				   Eigen::Ref<RowMatrixXd> out)
+  {
+    checkFieldsBatch(pos, out);
+
+    int rows   = pos.rows();
+    int nthrds = std::max<int>(1, std::min<int>(eval_threads(),
+						omp_get_max_threads()));
+
+#pragma omp parallel for schedule(static) num_threads(nthrds)
+    for (int n=0; n<rows; n++)
+      crt_fields(pos(n, 0), pos(n, 1), pos(n, 2), &out(n, 0));
+  }
+
   // This evaluation step is performed by all derived classes
   Eigen::MatrixXd& AccelFunc::evalaccel
   (Eigen::MatrixXd& ps, Eigen::MatrixXd& accel, BasisCoef mod)
@@ -2973,14 +3247,14 @@ namespace BasisClasses
     //
     auto basis = std::get<0>(mod);
 
-    // Get fields
+    // Get fields for all positions at once
     //
     int rows = accel.rows();
-    for (int n=0; n<rows; n++) {
-      auto v = basis->getFields(ps(n, 0), ps(n, 1), ps(n, 2));
-      // First 6 fields are density and potential, follewed by acceleration
-      for (int k=0; k<3; k++) accel(n, k) += v[6+k];
-    }
+    RowMatrixXd pos = ps.topLeftCorner(rows, 3);
+    auto v = basis->getFieldsBatch(pos);
+
+    // First 6 fields are density and potential, follewed by acceleration
+    accel.topLeftCorner(rows, 3) += v.middleCols(6, 3);
 
     return accel;
   }
@@ -3112,44 +3386,77 @@ namespace BasisClasses
     // END: component model loop
   }
   
-  //! Take one leap frog step; this can/should be generalized to a
-  //! one-step class in the long run
-  std::tuple<double, Eigen::MatrixXd>
+  //! Take one leap frog step in place and return the new time; this
+  //! can/should be generalized to a one-step class in the long run.
+  //! The drifts and kicks are split over OpenMP threads with the same
+  //! static partition of the orbits as the batched field evaluation.
+  static double
   OneStep(double t, double h,
 	  Eigen::MatrixXd& ps, Eigen::MatrixXd& accel,
-	  std::vector<BasisCoef> bfe, AccelFunctor F)
+	  const std::vector<BasisCoef>& bfe, AccelFunctor& F)
   {
     int rows = ps.rows();
 
     // Drift 1/2
+#pragma omp parallel for schedule(static)
     for (int n=0; n<rows; n++) {
       for (int k=0; k<3; k++) ps(n, k) += ps(n, 3+k)*0.5*h;
     }
 
-    // Kick
+    // Kick.  The functor installs the coefficients for time t once
+    // for all orbits and then evaluates the fields in one batch.
     accel.setZero();
     for (auto mod : bfe) {
       accel = F(t, ps, accel, mod);
     }
+
+#pragma omp parallel for schedule(static)
     for (int n=0; n<rows; n++) {
       for (int k=0; k<3; k++) ps(n, 3+k) += accel(n, k)*h;
-    }
-    
-    // Drift 1/2
-    for (int n=0; n<rows; n++) {
+      // Drift 1/2
       for (int k=0; k<3; k++) ps(n, k) += ps(n, 3+k)*0.5*h;
     }
 
+    return t + h;
+  }
+
+
+  // Number of steps and output frames for an orbit integration over
+  // [tinit, tfinal] with step h and at most nout frames
+  //
+  static std::pair<int, int>
+  OrbitSteps(double tinit, double tfinal, double h, int nout)
+  {
+    if (nout < 1) {
+      std::ostringstream sout;
+      sout << "IntegrateOrbits: the number of output frames must be "
+	   << "positive.  You specified nout=" << nout;
+      throw std::runtime_error(sout.str());
+    }
+
+    if ( (tfinal - tinit)/h >
+	 static_cast<double>(std::numeric_limits<int>::max()) )
+      throw std::runtime_error("IntegrateOrbits: step size is too small or "
+			       "time interval is too large");
+
+    int numT = floor( (tfinal - tinit)/h );
+
+    if (numT < 1) {
+      std::ostringstream sout;
+      sout << "IntegrateOrbits: time interval [" << tinit << ", " << tfinal
+	   << "] is shorter than the step size " << h;
+      throw std::runtime_error(sout.str());
+    }
 
-    return std::tuple<double, Eigen::MatrixXd>(t+h, ps);
+    return {numT, std::min<int>(numT, nout)};
   }
 
 
-  std::tuple<Eigen::VectorXd, Eigen::Tensor<float, 3>>
-  IntegrateOrbits
+  int
+  IntegrateOrbitsStream
   (double tinit, double tfinal, double h,
    Eigen::MatrixXd ps, std::vector<BasisCoef> bfe, AccelFunctor F,
-   int nout)
+   OrbitCallback out, int nout, int chunk)
   {
     int rows = ps.rows();
     int cols = ps.cols();
@@ -3163,77 +3470,183 @@ namespace BasisClasses
       throw std::runtime_error(sout.str());
     }
 
-    // Allocate the acceleration array
+    // Number of steps and frames
+    //
+    int numT;
+    std::tie(numT, nout) = OrbitSteps(tinit, tfinal, h, nout);
+
+    // Compute output step
+    //
+    double H = (tfinal - tinit)/nout;
+
+    // Frames per block: bound the buffer to about 256 MB by default
+    //
+    if (chunk <= 0) {
+      size_t bytes = sizeof(float)*6*std::max<size_t>(rows, 1);
+      chunk = std::max<size_t>(1, (size_t(1) << 28)/bytes);
+    }
+    chunk = std::min<int>(chunk, nout);
+
+    // Frame buffer
+    //
+    Eigen::Tensor<float, 3> buf;
+
+    try {
+      buf.resize(rows, 6, chunk);
+    }
+    catch (const std::bad_alloc& e) {
+      std::cout << "BasicFactor::IntegrateOrbits: memory allocation failed: "
+		<< e.what() << std::endl
+		<< "Your requested number of orbits and frames per block "
+		<< "requires " << floor(4.0*rows*6*chunk/1e9)+1
+		<< " GB free memory" << std::endl;
+      return 0;
+    }
+
+    Eigen::VectorXd times(chunk);
+    int first = 0, used = 0;
+
+    // Copy the current phase space to the next frame and pass a full
+    // block on to the callback
+    //
+    auto frame = [&](double t)
+    {
+      times(used) = t;
+      float* f = buf.data() + size_t(rows)*6*used;
+#pragma omp parallel for schedule(static)
+      for (int n=0; n<rows; n++)
+	for (int k=0; k<6; k++) f[n + size_t(rows)*k] = ps(n, k);
+
+      if (++used == chunk) {
+	out(first, times, OrbitFrames(buf.data(), rows, 6, used));
+	first += used;
+	used   = 0;
+      }
+    };
+
+    // Acceleration array
     //
     Eigen::MatrixXd accel(rows, 3);
 
-    // Sanity check
+    // Do the work.  The first frame is the initial condition and the
+    // last frame is the final state.
     //
-    if ( (tfinal - tinit)/h >
-	 static_cast<double>(std::numeric_limits<int>::max()) )
-      {
-	std::cout << "BasicFactor::IntegrateOrbits: step size is too small or "
-		  << "time interval is too large.\n";
-	// Return empty data
-	//
-	return {Eigen::VectorXd(), Eigen::Tensor<float, 3>()};
+    if (nout > 1) frame(tinit);
+
+    double tnow = tinit;
+    for (int s=1, cnt=1; s<numT; s++) {
+      tnow = OneStep(tnow, h, ps, accel, bfe, F);
+      if (cnt < nout-1 and tnow >= tinit + H*cnt - h*1.0e-8) {
+	frame(tnow);
+	cnt += 1;
       }
-    
-    // Number of steps
+    }
+
+    frame(tnow);
+
+    // Partial last block
     //
-    int numT = floor( (tfinal - tinit)/h );
+    if (used) {
+      Eigen::VectorXd T = times.head(used);
+      out(first, T, OrbitFrames(buf.data(), rows, 6, used));
+    }
 
-    // Compute output step
+    return nout;
+  }
+
+
+  std::tuple<Eigen::VectorXd, Eigen::Tensor<float, 3>>
+  IntegrateOrbits
+  (double tinit, double tfinal, double h,
+   Eigen::MatrixXd ps, std::vector<BasisCoef> bfe, AccelFunctor F,
+   int nout)
+  {
+    int rows = ps.rows();
+
+    // Number of frames
     //
-    nout = std::min<int>(numT, nout);
-    double H = (tfinal - tinit)/nout;
+    int nframes = OrbitSteps(tinit, tfinal, h, nout).second;
 
     // Return data
     //
+    Eigen::VectorXd times;
     Eigen::Tensor<float, 3> ret;
 
     try {
-      ret.resize(rows, 6, nout);
+      ret.resize(rows, 6, nframes);
     }
     catch (const std::bad_alloc& e) {
       std::cout << "BasicFactor::IntegrateOrbits: memory allocation failed: "
 		<< e.what() << std::endl
 		<< "Your requested number of orbits and time steps requires "
-		<< floor(8.0*rows*6*nout/1e9)+1 << " GB free memory"
-		<< std::endl;
+		<< floor(4.0*rows*6*nframes/1e9)+1 << " GB free memory"
+		<< std::endl
+		<< "Use IntegrateOrbitsStream or IntegrateOrbitsH5 to write "
+		<< "the orbits in blocks" << std::endl;
 
       // Return empty data
       //
       return {Eigen::VectorXd(), Eigen::Tensor<float, 3>()};
     }
 
-    // Time array
-    //
-    Eigen::VectorXd times(nout);
-    
-    // Do the work
+    times.resize(nframes);
+
+    // Each block is a contiguous run of frames in the return tensor
     //
-    times(0) = tinit;
-    for (int n=0; n<rows; n++)
-      for (int k=0; k<6; k++) ret(n, k, 0) = ps(n, k);
+    auto copy = [&](int first, const Eigen::VectorXd& T, const OrbitFrames& f)
+    {
+      int n = T.size();
+      times.segment(first, n) = T;
+      std::copy(f.data(), f.data() + f.size(),
+		ret.data() + size_t(rows)*6*first);
+    };
 
-    double tnow = tinit;
-    for (int s=1, cnt=1; s<numT; s++) {
-      std::tie(tnow, ps) = OneStep(tnow, h, ps, accel, bfe, F);
-      if (tnow >= H*cnt-h*1.0e-8) {
-	times(cnt) = tnow;
-	for (int n=0; n<rows; n++)
-	  for (int k=0; k<6; k++) ret(n, k, cnt) = ps(n, k);
-	cnt += 1;
-      }
-    }
+    if (IntegrateOrbitsStream(tinit, tfinal, h, ps, bfe, F, copy, nout) == 0)
+      return {Eigen::VectorXd(), Eigen::Tensor<float, 3>()};
 
-    times(nout-1) = tnow;
-    for (int n=0; n<rows; n++)
-      for (int k=0; k<6; k++) ret(n, k, nout-1) = ps(n, k);
-    
     return {times, ret};
   }
 
+
+  int
+  IntegrateOrbitsH5
+  (double tinit, double tfinal, double h,
+   Eigen::MatrixXd ps, std::vector<BasisCoef> bfe, AccelFunctor F,
+   const std::string& file, int nout, int chunk)
+  {
+    size_t rows = ps.rows();
+
+    // Number of frames
+    //
+    size_t nframes = OrbitSteps(tinit, tfinal, h, nout).second;
+
+    HighFive::File h5file(file, HighFive::File::ReadWrite |
+			  HighFive::File::Create | HighFive::File::Truncate);
+
+    h5file.createAttribute<double>("tinit",  HighFive::DataSpace::From(tinit )).write(tinit );
+    h5file.createAttribute<double>("tfinal", HighFive::DataSpace::From(tfinal)).write(tfinal);
+    h5file.createAttribute<double>("h",      HighFive::DataSpace::From(h     )).write(h     );
+
+    // A frame block in the column-major (orbits, 6, frames) buffer is
+    // a row-major (frames, 6, orbits) hyperslab
+    //
+    auto dtim = h5file.createDataSet<double>
+      ("times", HighFive::DataSpace({nframes}));
+
+    auto dorb = h5file.createDataSet<float>
+      ("orbits", HighFive::DataSpace({nframes, 6, rows}));
+
+    auto write = [&](int first, const Eigen::VectorXd& T, const OrbitFrames& f)
+    {
+      size_t n = T.size();
+      std::vector<double> tt(T.data(), T.data() + n);
+      dtim.select({size_t(first)}, {n}).write(tt);
+      dorb.select({size_t(first), 0, 0}, {n, 6, rows}).write_raw(f.data());
+    };
+
+    return IntegrateOrbitsStream(tinit, tfinal, h, ps, bfe, F, write,
+				 nout, chunk);
+  }
+
 }
 // END namespace BasisClasses
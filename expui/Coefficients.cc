@@ -1,4 +1,5 @@
 #include <filesystem>
+#include <algorithm>
 #include <iterator>
 #include <iostream>
 #include <fstream>
@@ -29,6 +30,10 @@ namespace CoefClasses
     p->name     = name;
     p->verbose  = verbose;
     p->times    = times;
+    p->h5series = h5series;
+    p->h5shuffle= h5shuffle;
+    p->h5chunk  = h5chunk;
+    p->h5deflate= h5deflate;
   }
 
   std::tuple<Eigen::VectorXcd&, bool> Coefs::interpolate(double time)
@@ -91,6 +96,35 @@ namespace CoefClasses
     file.getAttribute("geometry").read(geometry);
     file.getAttribute("forceID" ).read(forceID );
     
+    // Chunked time-series layout
+    //
+    if (file.exist("series")) {
+      ReadH5Series(file, stride, Tmin, Tmax,
+		   [&](double Time, std::vector<double>& ctr,
+		       Eigen::VectorXcd& in)
+		   {
+		     auto coef = std::make_shared<SphStruct>();
+
+		     if (ctr.size()) coef->ctr = ctr;
+
+		     coef->lmax  = Lmax;
+		     coef->nmax  = Nmax;
+		     coef->time  = Time;
+		     coef->scale = scale;
+		     coef->geom  = geometry;
+		     coef->id    = forceID;
+
+		     coef->allocate();
+		     coef->store = in;
+
+		     coefs[roundTime(Time)] = coef;
+		   });
+
+      times.clear();
+      for (auto t : coefs) times.push_back(t.first);
+      return;
+    }
+
     // Look for Coef output version to toggle backward compatibility
     // with legacy storage order
     //
@@ -277,6 +311,36 @@ namespace CoefClasses
     file.getAttribute("geometry").read(geometry);
     file.getAttribute("fieldID" ).read(fieldID );
     
+    // Chunked time-series layout
+    //
+    if (file.exist("series")) {
+      ReadH5Series(file, stride, Tmin, Tmax,
+		   [&](double Time, std::vector<double>& ctr,
+		       Eigen::VectorXcd& in)
+		   {
+		     auto coef = std::make_shared<SphFldStruct>();
+
+		     if (ctr.size()) coef->ctr = ctr;
+
+		     coef->nfld  = Nfld;
+		     coef->lmax  = Lmax;
+		     coef->nmax  = Nmax;
+		     coef->time  = Time;
+		     coef->scale = scale;
+		     coef->geom  = geometry;
+		     coef->id    = fieldID;
+
+		     coef->allocate();
+		     coef->store = in;
+
+		     coefs[roundTime(Time)] = coef;
+		   });
+
+      times.clear();
+      for (auto t : coefs) times.push_back(t.first);
+      return;
+    }
+
     // Open the snapshot group
     //
     auto snaps = file.getGroup("snapshots");
@@ -368,6 +432,36 @@ namespace CoefClasses
     file.getAttribute("geometry").read(geometry);
     file.getAttribute("fieldID" ).read(fieldID );
     
+    // Chunked time-series layout
+    //
+    if (file.exist("series")) {
+      ReadH5Series(file, stride, Tmin, Tmax,
+		   [&](double Time, std::vector<double>& ctr,
+		       Eigen::VectorXcd& in)
+		   {
+		     auto coef = std::make_shared<CylFldStruct>();
+
+		     if (ctr.size()) coef->ctr = ctr;
+
+		     coef->nfld  = Nfld;
+		     coef->mmax  = Mmax;
+		     coef->nmax  = Nmax;
+		     coef->time  = Time;
+		     coef->scale = scale;
+		     coef->geom  = geometry;
+		     coef->id    = fieldID;
+
+		     coef->allocate();
+		     coef->store = in;
+
+		     coefs[roundTime(Time)] = coef;
+		   });
+
+      times.clear();
+      for (auto t : coefs) times.push_back(t.first);
+      return;
+    }
+
     // Open the snapshot group
     //
     auto snaps = file.getGroup("snapshots");
@@ -798,6 +892,32 @@ namespace CoefClasses
     file.getAttribute("config" ).read(config);
     file.getDataSet  ("count"  ).read(count );
     
+    // Chunked time-series layout
+    //
+    if (file.exist("series")) {
+      ReadH5Series(file, stride, Tmin, Tmax,
+		   [&](double Time, std::vector<double>& ctr,
+		       Eigen::VectorXcd& in)
+		   {
+		     auto coef = std::make_shared<CylStruct>();
+
+		     if (ctr.size()) coef->ctr = ctr;
+
+		     coef->mmax  = Mmax;
+		     coef->nmax  = Nmax;
+		     coef->time  = Time;
+
+		     coef->allocate();
+		     coef->store = in;
+
+		     coefs[roundTime(Time)] = coef;
+		   });
+
+      times.clear();
+      for (auto t : coefs) times.push_back(t.first);
+      return;
+    }
+
     // Look for Coef output version to toggle backward compatibility
     // with legacy storage order
     //
@@ -1193,6 +1313,33 @@ namespace CoefClasses
     file.getAttribute("config" ).read(config);
     file.getDataSet  ("count"  ).read(count );
     
+    // Chunked time-series layout
+    //
+    if (file.exist("series")) {
+      ReadH5Series(file, stride, Tmin, Tmax,
+		   [&](double Time, std::vector<double>& ctr,
+		       Eigen::VectorXcd& in)
+		   {
+		     auto coef = std::make_shared<SlabStruct>();
+
+		     if (ctr.size()) coef->ctr = ctr;
+
+		     coef->nmaxx = NmaxX;
+		     coef->nmaxy = NmaxY;
+		     coef->nmaxz = NmaxZ;
+		     coef->time  = Time;
+
+		     coef->allocate();
+		     coef->store = in;
+
+		     coefs[roundTime(Time)] = coef;
+		   });
+
+      times.clear();
+      for (auto t : coefs) times.push_back(t.first);
+      return;
+    }
+
     // Open the snapshot group
     //
     auto snaps = file.getGroup("snapshots");
@@ -1545,6 +1692,33 @@ namespace CoefClasses
     file.getAttribute("config" ).read(config);
     file.getDataSet  ("count"  ).read(count );
     
+    // Chunked time-series layout
+    //
+    if (file.exist("series")) {
+      ReadH5Series(file, stride, Tmin, Tmax,
+		   [&](double Time, std::vector<double>& ctr,
+		       Eigen::VectorXcd& in)
+		   {
+		     auto coef = std::make_shared<CubeStruct>();
+
+		     if (ctr.size()) coef->ctr = ctr;
+
+		     coef->nmaxx = NmaxX;
+		     coef->nmaxy = NmaxY;
+		     coef->nmaxz = NmaxZ;
+		     coef->time  = Time;
+
+		     coef->allocate();
+		     coef->store = in;
+
+		     coefs[roundTime(Time)] = coef;
+		   });
+
+      times.clear();
+      for (auto t : coefs) times.push_back(t.first);
+      return;
+    }
+
     // Open the snapshot group
     //
     auto snaps = file.getGroup("snapshots");
@@ -1929,6 +2103,31 @@ namespace CoefClasses
     file.getAttribute("config").read(config);
     file.getDataSet  ("count" ).read(count);
 
+    // Chunked time-series layout
+    //
+    if (file.exist("series")) {
+      ReadH5Series(file, stride, Tmin, Tmax,
+		   [&](double Time, std::vector<double>& ctr,
+		       Eigen::VectorXcd& in)
+		   {
+		     auto coef = std::make_shared<TblStruct>();
+		     coef->cols  = cols;
+		     coef->time  = Time;
+		     coef->allocate();
+		     coef->store = in;
+
+		     std::vector<double> row(cols);
+		     for (int i=0; i<cols; i++) row[i] = std::real(in(i));
+		     data.push_back(row);
+
+		     coefs[roundTime(Time)] = coef;
+		   });
+
+      times.clear();
+      for (auto t : coefs) times.push_back(t.first);
+      return;
+    }
+
     auto snaps = file.getGroup("snapshots");
     
     snaps.getDataSet("times").read(times);
@@ -2286,6 +2485,30 @@ namespace CoefClasses
     return ret;
   }
   
+  void Coefs::WriteH5Header(HighFive::File& file)
+  {
+    // Write the Version string
+    //
+    file.createAttribute<std::string>("CoefficientOutputVersion", HighFive::DataSpace::From(CoefficientOutputVersion)).write(CoefficientOutputVersion);
+
+    // We write the coefficient file geometry
+    //
+    file.createAttribute<std::string>("geometry", HighFive::DataSpace::From(geometry)).write(geometry);
+      
+    // We write the coefficient mnemonic
+    //
+    file.createAttribute<std::string>("name", HighFive::DataSpace::From(name)).write(name);
+      
+    // Stash the basis configuration (this is not yet implemented in EXP)
+    //
+    std::string config(getYAML());
+    file.createAttribute<std::string>("config", HighFive::DataSpace::From(config)).write(config);
+      
+    // Write the specific parameters
+    //
+    WriteH5Params(file);
+  }
+
   void Coefs::WriteH5Coefs(const std::string& prefix)
   {
     try {
@@ -2295,39 +2518,27 @@ namespace CoefClasses
 			  HighFive::File::ReadWrite |
 			  HighFive::File::Create);
       
-      // Write the Version string
+      // Write the attributes
       //
-      file.createAttribute<std::string>("CoefficientOutputVersion", HighFive::DataSpace::From(CoefficientOutputVersion)).write(CoefficientOutputVersion);
-
-      // We write the coefficient file geometry
-      //
-      file.createAttribute<std::string>("geometry", HighFive::DataSpace::From(geometry)).write(geometry);
-      
-      // We write the coefficient mnemonic
-      //
-      file.createAttribute<std::string>("name", HighFive::DataSpace::From(name)).write(name);
-      
-      // Stash the basis configuration (this is not yet implemented in EXP)
-      //
-      std::string config(getYAML());
-      file.createAttribute<std::string>("config", HighFive::DataSpace::From(config)).write(config);
-      
-      // Write the specific parameters
-      //
-      WriteH5Params(file);
+      WriteH5Header(file);
       
       // Group count variable
       //
       unsigned count = 0;
       HighFive::DataSet dataset = file.createDataSet("count", count);
       
-      // Create a new group for coefficient snapshots
+      // Time-series layout: one extendible dataset for all snapshots
       //
-      HighFive::Group group = file.createGroup("snapshots");
-      
-      // Write the coefficients
+      if (h5series) {
+	HighFive::Group group = file.createGroup("series");
+	count = WriteH5Rows(group, count);
+      }
+      // Create a new group for coefficient snapshots
       //
-      count = WriteH5Times(group, count);
+      else {
+	HighFive::Group group = file.createGroup("snapshots");
+	count = WriteH5Times(group, count);
+      }
       
       // Update the count
       //
@@ -2352,11 +2563,19 @@ namespace CoefClasses
       unsigned count;
       dataset.read(count);
       
-      HighFive::Group group = file.getGroup("snapshots");
-      
+      // Append rows to the series datasets.  This is a resize and a
+      // single hyperslab write regardless of the length of the series.
+      //
+      if (file.exist("series")) {
+	HighFive::Group group = file.getGroup("series");
+	count = WriteH5Rows(group, count);
+      }
       // Write the coefficients
       //
-      count = WriteH5Times(group, count);
+      else {
+	HighFive::Group group = file.getGroup("snapshots");
+	count = WriteH5Times(group, count);
+      }
       
       // Update the count
       //
@@ -2368,6 +2587,216 @@ namespace CoefClasses
     
   }
   
+  unsigned Coefs::WriteH5Rows(HighFive::Group& series, unsigned count)
+  {
+    auto T = Times();
+    size_t nt = T.size();
+    if (nt==0) return count;
+
+    auto first = getCoefStruct(T[0]);
+    size_t ncoef = first->store.size();
+
+    // Create the datasets on the first write.  Rows are snapshots
+    // and the coefficient dimension is fixed.  A coefficient chunk
+    // holds at most h5chunk rows and is capped at the size of the
+    // default HDF5 chunk cache (1 MB), splitting the coefficient
+    // axis if a single row is larger, so that an append or a
+    // coefficient-subset read only touches cached chunks.
+    //
+    if (not series.exist("coefficients")) {
+
+      const size_t cacheBytes = 1 << 20;
+      const size_t rowBytes   = sizeof(std::complex<double>)*ncoef;
+
+      size_t chunk = std::clamp<size_t>(cacheBytes/rowBytes, 1, h5chunk);
+      size_t ccols = std::clamp<size_t>
+	(cacheBytes/(sizeof(std::complex<double>)*chunk), 1, ncoef);
+
+      HighFive::DataSetCreateProps tprops, cprops, xprops;
+      tprops.add(HighFive::Chunking(std::vector<hsize_t>{h5chunk}));
+      cprops.add(HighFive::Chunking(std::vector<hsize_t>{chunk, ccols}));
+      xprops.add(HighFive::Chunking(std::vector<hsize_t>{h5chunk, 3}));
+
+      if (h5shuffle) cprops.add(HighFive::Shuffle());
+      if (h5deflate>0) cprops.add(HighFive::Deflate(h5deflate));
+
+      const size_t U = HighFive::DataSpace::UNLIMITED;
+
+      series.createDataSet<double>
+	("times", HighFive::DataSpace({0}, {U}), tprops);
+
+      series.createDataSet<std::complex<double>>
+	("coefficients", HighFive::DataSpace({0, ncoef}, {U, ncoef}), cprops);
+
+      if (first->ctr.size()==3)
+	series.createDataSet<double>
+	  ("centers", HighFive::DataSpace({0, 3}, {U, 3}), xprops);
+    }
+
+    auto dtim = series.getDataSet("times");
+    auto dcof = series.getDataSet("coefficients");
+
+    if (dcof.getDimensions()[1] != ncoef) {
+      std::ostringstream sout;
+      sout << "Coefs::WriteH5Rows: coefficient dimension " << ncoef
+	   << " does not match the series dimension "
+	   << dcof.getDimensions()[1];
+      throw CoefsError(sout.str());
+    }
+
+    // Pack the snapshots.  Each column of the Eigen buffer is a row
+    // of the dataset so the column-major storage is the row-major
+    // hyperslab.
+    //
+    std::vector<double> tt(nt);
+    Eigen::MatrixXcd buf(ncoef, nt);
+    Eigen::MatrixXd  ctr = Eigen::MatrixXd::Zero(3, nt);
+
+    for (size_t n=0; n<nt; n++) {
+      auto C = getCoefStruct(T[n]);
+      if (C->store.size() != ncoef)
+	throw CoefsError("Coefs::WriteH5Rows: snapshots differ in size");
+      tt[n]      = C->time;
+      buf.col(n) = C->store;
+      if (C->ctr.size()==3)
+	for (int k=0; k<3; k++) ctr(k, n) = C->ctr[k];
+    }
+
+    dtim.resize({count+nt});
+    dtim.select({count}, {nt}).write(tt);
+
+    dcof.resize({count+nt, ncoef});
+    dcof.select({count, 0}, {nt, ncoef}).write_raw(buf.data());
+
+    if (series.exist("centers")) {
+      auto dctr = series.getDataSet("centers");
+      dctr.resize({count+nt, 3});
+      dctr.select({count, 0}, {nt, 3}).write_raw(ctr.data());
+    }
+
+    return count + nt;
+  }
+
+  void Coefs::ReadH5Series
+  (HighFive::File& file, int stride, double tmin, double tmax,
+   std::function<void(double, std::vector<double>&, Eigen::VectorXcd&)> pack)
+  {
+    auto series = file.getGroup("series");
+
+    std::vector<double> T;
+    series.getDataSet("times").read(T);
+
+    auto dcof = series.getDataSet("coefficients");
+    size_t ncoef = dcof.getDimensions()[1];
+
+    bool center = series.exist("centers");
+
+    // The rows selected by stride and time range; only the span
+    // from the first to the last of these is read
+    //
+    stride = std::max<int>(stride, 1);
+
+    size_t first = T.size(), last = 0;
+    for (size_t n=0; n<T.size(); n+=stride) {
+      if (T[n] < tmin or T[n] > tmax) continue;
+      first = std::min<size_t>(first, n);
+      last  = n;
+    }
+
+    if (first > last) return;
+
+    // Read in blocks of strided rows to bound the working memory
+    //
+    const size_t block = 1024;
+
+    Eigen::MatrixXcd buf;
+    Eigen::MatrixXd  ctr;
+    Eigen::VectorXcd in(ncoef);
+    std::vector<double> C;
+
+    for (size_t n0=first; n0<=last; n0+=block*stride) {
+
+      size_t nr = std::min<size_t>(block, (last - n0)/stride + 1);
+
+      buf.resize(ncoef, nr);
+      dcof.select({n0, 0}, {nr, ncoef}, {size_t(stride), 1})
+	.read(buf.data(), HighFive::create_datatype<std::complex<double>>());
+
+      if (center) {
+	ctr.resize(3, nr);
+	series.getDataSet("centers").select({n0, 0}, {nr, 3}, {size_t(stride), 1})
+	  .read(ctr.data(), HighFive::create_datatype<double>());
+      }
+
+      for (size_t r=0; r<nr; r++) {
+	double Time = T[n0 + r*stride];
+	if (Time < tmin or Time > tmax) continue;
+
+	C.clear();
+	if (center) C = {ctr(0, r), ctr(1, r), ctr(2, r)};
+
+	in = buf.col(r);
+	pack(Time, C, in);
+      }
+    }
+  }
+
+  std::tuple<std::vector<double>, Eigen::MatrixXcd>
+  Coefs::ReadH5Block(const std::string& file, double tmin, double tmax,
+		     size_t cmin, size_t cmax)
+  {
+    HighFive::File h5file(file, HighFive::File::ReadOnly);
+
+    if (not h5file.exist("series"))
+      throw CoefsError("Coefs::ReadH5Block: <" + file +
+		       "> does not use the time-series layout");
+
+    auto series = h5file.getGroup("series");
+
+    std::vector<double> T, ret;
+    series.getDataSet("times").read(T);
+
+    auto dcof = series.getDataSet("coefficients");
+    size_t ncoef = dcof.getDimensions()[1];
+
+    cmax = std::min<size_t>(cmax, ncoef);
+    if (cmin >= cmax)
+      throw CoefsError("Coefs::ReadH5Block: empty coefficient range");
+
+    // Contiguous row span covering the time range
+    //
+    size_t first = T.size(), last = 0;
+    for (size_t n=0; n<T.size(); n++) {
+      if (T[n] < tmin or T[n] > tmax) continue;
+      first = std::min<size_t>(first, n);
+      last  = n;
+    }
+
+    if (first > last) return {ret, Eigen::MatrixXcd()};
+
+    size_t nr = last - first + 1, nc = cmax - cmin;
+
+    Eigen::MatrixXcd buf(nc, nr);
+    dcof.select({first, cmin}, {nr, nc})
+      .read(buf.data(), HighFive::create_datatype<std::complex<double>>());
+
+    // Keep only the rows within the time range
+    //
+    std::vector<size_t> rows;
+    for (size_t r=0; r<nr; r++) {
+      double t = T[first + r];
+      if (t >= tmin and t <= tmax) rows.push_back(r);
+    }
+
+    Eigen::MatrixXcd out(rows.size(), nc);
+    for (size_t i=0; i<rows.size(); i++) {
+      out.row(i) = buf.col(rows[i]).transpose();
+      ret.push_back(T[first + rows[i]]);
+    }
+
+    return {ret, out};
+  }
+  
   void CylCoefs::add(CoefStrPtr coef)
   {
     auto p = std::dynamic_pointer_cast<CylStruct>(coef);
@@ -2995,5 +3424,199 @@ namespace CoefClasses
     return ret;
   }
 
+  LazyCoefs::LazyCoefs(const std::string& file, size_t cache, bool verbose) :
+    Coefs("lazy", verbose), file(file), capacity(std::max<size_t>(cache, 1))
+  {
+    h5 = std::make_shared<HighFive::File>(file, HighFive::File::ReadOnly);
+
+    if (not h5->exist("series"))
+      throw CoefsError("LazyCoefs: <" + file + "> does not use the "
+		       "time-series layout; rewrite it with setH5Layout(true)");
+
+    h5->getAttribute("geometry").read(geometry);
+    h5->getAttribute("name"    ).read(name    );
+    h5->getAttribute("config"  ).read(config  );
+
+    // Index the times; this is the only full read
+    //
+    auto series = h5->getGroup("series");
+    series.getDataSet("times").read(times);
+
+    ncoef  = series.getDataSet("coefficients").getDimensions()[1];
+    center = series.exist("centers");
+
+    if (times.size()==0)
+      throw CoefsError("LazyCoefs: <" + file + "> has no snapshots");
+
+    for (size_t n=0; n<times.size(); n++) rows[roundTime(times[n])] = n;
+
+    // A typed container holding the first snapshot provides the
+    // type-specific members and the prototype structure
+    //
+    shell = Coefs::factory(file, 1, times[0], times[0]);
+    proto = shell->getCoefStruct(shell->Times().front());
+    geometry = shell->getGeometry();
+
+    // Report times in order, as the in-memory containers do
+    //
+    times.clear();
+    for (auto v : rows) times.push_back(v.first);
+  }
+
+  std::vector<CoefStrPtr> LazyCoefs::readRows(size_t r0, size_t n)
+  {
+    auto series = h5->getGroup("series");
+
+    std::vector<double> T(n);
+    series.getDataSet("times").select({r0}, {n}).read(T);
+
+    Eigen::MatrixXcd buf(ncoef, n);
+    series.getDataSet("coefficients").select({r0, 0}, {n, ncoef})
+      .read(buf.data(), HighFive::create_datatype<std::complex<double>>());
+
+    Eigen::MatrixXd ctr;
+    if (center) {
+      ctr.resize(3, n);
+      series.getDataSet("centers").select({r0, 0}, {n, 3})
+	.read(ctr.data(), HighFive::create_datatype<double>());
+    }
+
+    std::vector<CoefStrPtr> ret(n);
+
+    for (size_t i=0; i<n; i++) {
+      ret[i] = proto->deepcopy();
+      ret[i]->store = buf.col(i);
+      ret[i]->time  = T[i];
+      if (center) ret[i]->ctr = {ctr(0, i), ctr(1, i), ctr(2, i)};
+      else        ret[i]->ctr.clear();
+    }
+
+    return ret;
+  }
+
+  std::shared_ptr<CoefStruct> LazyCoefs::getCoefStruct(double time)
+  {
+    double key = roundTime(time);
+
+    // Cache hit: move to the front
+    //
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+      lru.splice(lru.begin(), lru, it->second);
+      return it->second->second;
+    }
+
+    auto jt = rows.find(key);
+    if (jt == rows.end()) {
+      std::ostringstream sout;
+      sout << "LazyCoefs::getCoefStruct: requested time=" << time
+	   << " not found";
+      throw CoefsError(sout.str());
+    }
+
+    auto p = readRows(jt->second, 1)[0];
+
+    lru.push_front({key, p});
+    cache[key] = lru.begin();
+
+    // Evict the least recently used
+    //
+    while (lru.size() > capacity) {
+      cache.erase(lru.back().first);
+      lru.pop_back();
+    }
+
+    return p;
+  }
+
+  Eigen::VectorXcd& LazyCoefs::getData(double time)
+  {
+    if (rows.find(roundTime(time)) == rows.end())
+      arr.resize(0);
+    else
+      arr = getCoefStruct(time)->store;
+
+    return arr;
+  }
+
+  void LazyCoefs::setCacheSize(size_t n)
+  {
+    capacity = std::max<size_t>(n, 1);
+    while (lru.size() > capacity) {
+      cache.erase(lru.back().first);
+      lru.pop_back();
+    }
+  }
+
+  std::shared_ptr<Coefs> LazyCoefs::Slice(double tmin, double tmax, int stride)
+  {
+    return Coefs::factory(file, stride, tmin, tmax);
+  }
+
+  void LazyCoefs::Stream(std::function<void(CoefStrPtr)> func,
+			 double tmin, double tmax, size_t block)
+  {
+    // Contiguous row span covering the time range
+    //
+    size_t first = std::numeric_limits<size_t>::max(), last = 0;
+    for (auto v : rows) {
+      if (v.first < tmin or v.first > tmax) continue;
+      first = std::min<size_t>(first, v.second);
+      last  = std::max<size_t>(last,  v.second);
+    }
+
+    if (first > last) return;
+
+    block = std::max<size_t>(block, 1);
+
+    for (size_t r0=first; r0<=last; r0+=block) {
+      size_t n = std::min<size_t>(block, last - r0 + 1);
+      for (auto p : readRows(r0, n)) {
+	if (p->time < tmin or p->time > tmax) continue;
+	func(p);
+      }
+    }
+  }
+
+  Eigen::MatrixXd& LazyCoefs::Power(int min, int max)
+  {
+    // Compute the power a block of snapshots at a time in a
+    // temporary typed container and stack the rows
+    //
+    const size_t block = 1024;
+
+    auto work = shell->deepcopy();
+    std::vector<Eigen::MatrixXd> parts;
+    size_t nrows = 0, count = 0;
+
+    auto flush = [&]()
+    {
+      if (count==0) return;
+      parts.push_back(work->Power(min, max));
+      nrows += parts.back().rows();
+      work->clear();
+      count = 0;
+    };
+
+    work->clear();
+    Stream([&](CoefStrPtr p)
+    {
+      work->add(p);
+      if (++count >= block) flush();
+    });
+    flush();
+
+    if (parts.size()==0) {
+      power.resize(0, 0);
+      return power;
+    }
+
+    power.resize(nrows, parts[0].cols());
+    for (size_t i=0, r=0; i<parts.size(); r+=parts[i].rows(), i++)
+      power.block(r, 0, parts[i].rows(), parts[i].cols()) = parts[i];
+
+    return power;
+  }
+
 }
 // END namespace CoefClasses
@@ -38,6 +38,7 @@
 #include <EmpCylSL.H>
 #include <DataGrid.H>
 
+#include <ThreadPool.H>
 #include <libvars.H>
 using namespace __EXP__;	// For reference to n-body globals
 
@@ -51,6 +52,7 @@ bool     EmpCylSL::PCAEOF          = false;
 bool     EmpCylSL::PCADRY          = true;
 bool     EmpCylSL::logarithmic     = false;
 bool     EmpCylSL::enforce_limits  = false;
+bool     EmpCylSL::packed_tables   = false;
 int      EmpCylSL::CMAPR           = 1;
 int      EmpCylSL::CMAPZ           = 1;
 int      EmpCylSL::NUMX            = 256;
@@ -79,7 +81,7 @@ std::map<EmpCylSL::EmpModel, std::string> EmpCylSL::EmpModelLabs =
   };
 
 
-EmpCylSL::EmpCylSL()
+EmpCylSL::EmpCylSL() : nthrds(__EXP__::nthrds)
 {
   NORDER     = 0;
   eof_made   = false;
@@ -134,7 +136,8 @@ EmpCylSL::~EmpCylSL(void)
 
 EmpCylSL::EmpCylSL(int nmax, int lmax, int mmax, int nord, 
 		   double ascale, double hscale, int nodd,
-		   std::string cachename)
+		   std::string cachename, int nthreads) :
+  nthrds(nthreads>0 ? nthreads : __EXP__::nthrds)
 {
   // Use default name?
   if (cachename.size()) cachefile = cachename;
@@ -231,7 +234,8 @@ U getH5(std::string name, HighFive::File& file)
   }
 }
 
-EmpCylSL::EmpCylSL(int mlim, std::string cachename)
+EmpCylSL::EmpCylSL(int mlim, std::string cachename, int nthreads) :
+  nthrds(nthreads>0 ? nthreads : __EXP__::nthrds)
 {
   // Use default name?
   //
@@ -887,6 +891,7 @@ int EmpCylSL::read_eof_file(const string& eof_file)
   // EOF basis complete but need to compute coefficients
   //
   eof_made = true;
+  pack_tables();
   std::fill(coefs_made.begin(), coefs_made.end(), false);
 
   return 1;
@@ -916,6 +921,7 @@ int EmpCylSL::read_cache(void)
   // EOF complete, but still need to compute coefficients
   //
   eof_made = true;
+  pack_tables();
   std::fill(coefs_made.begin(), coefs_made.end(), false);
 
   return 1;
@@ -1873,50 +1879,39 @@ void EmpCylSL::setup_accumulation(int mlevel)
 
     cylmass_made = false;
 
-    for (unsigned M=0; M<=multistep; M++) {
-      
-      for (int nth=0; nth<nthrds; nth++) {
-	
+    // Allocate and zero the per-thread accumulators on the pool
+    // thread that fills them so that they are local to its NUMA node
+    //
+    ThreadPool::get().run(nthrds, [this](int nth) {
+
+      for (unsigned M=0; M<=multistep; M++) {
 	for (int m=0; m<=MMAX; m++) {
-	  
-	  cosN(M)[nth][m].resize(NORDER);
-	  cosL(M)[nth][m].resize(NORDER);
-	  
+	  cosN(M)[nth][m].setZero(NORDER);
+	  cosL(M)[nth][m].setZero(NORDER);
 	  if (m>0) {
-	    sinN(M)[nth][m].resize(NORDER);
-	    sinL(M)[nth][m].resize(NORDER);
+	    sinN(M)[nth][m].setZero(NORDER);
+	    sinL(M)[nth][m].setZero(NORDER);
 	  }
 	}
       }
-    }
-    
-    for (int m=0; m<=MMAX; m++) {
-      accum_cos[m].resize(NORDER);
-      if (m>0) accum_sin[m].resize(NORDER);
-    }
-    
-    for (unsigned M=0; M<=multistep; M++) {
-      for (int nth=0; nth<nthrds; nth++) {
-	for (int m=0; m<=MMAX; m++) {
-	  cosN(M)[nth][m].setZero();
-	  if (m>0) sinN(M)[nth][m].setZero();
-	}
-      }
-    }
 
-    if (PCAVAR and sampT>0) {
-      for (int nth=0; nth<nthrds; nth++) {
+      if (PCAVAR and sampT>0) {
 	for (unsigned T=0; T<sampT; T++) {
 	  numbT1[nth][T] = 0;
 	  massT1[nth][T] = 0.0;
 	  covV[nth][T].resize(MMAX+1);
 	  covM[nth][T].resize(MMAX+1);
 	  for (int mm=0; mm<=MMAX; mm++) {
-	    covV[nth][T][mm].resize(NORDER);
-	    covM[nth][T][mm].resize(NORDER, NORDER);
+	    covV[nth][T][mm].setZero(NORDER);
+	    covM[nth][T][mm].setZero(NORDER, NORDER);
 	  }
 	}
       }
+    });
+
+    for (int m=0; m<=MMAX; m++) {
+      accum_cos[m].resize(NORDER);
+      if (m>0) accum_sin[m].resize(NORDER);
     }
   }
 
@@ -1990,8 +1985,6 @@ void EmpCylSL::init_pca()
       else          sampT = floor(sqrt(nbodstot));
     }
 
-    pthread_mutex_init(&used_lock, NULL);
-
     if (PCAEOF)
       tvar.resize(nthrds);
 
@@ -3217,6 +3210,7 @@ void EmpCylSL::make_eof(void)
   // Basis complete but still need to compute coefficients
   //
   eof_made = true;
+  pack_tables();
   std::fill(coefs_made.begin(), coefs_made.end(), false);
 
   if (VFLAG & 2) {
@@ -3792,16 +3786,9 @@ void EmpCylSL::accumulate_eof_thread(std::vector<Particle>& part, bool verbose)
 {
   setup_eof();
     
-  std::vector<std::thread> t(nthrds);
-  
-  // Launch the threads
-  for (int id=0; id<nthrds; ++id) {
-    t[id] = std::thread(&EmpCylSL::accumulate_eof_thread_call, this, id, &part, verbose);
-  }
-  // Join the threads
-  for (int id=0; id<nthrds; ++id) {
-    t[id].join();
-  }
+  ThreadPool::get().run(nthrds, [&](int id) {
+    accumulate_eof_thread_call(id, &part, verbose);
+  });
 }
 
 void EmpCylSL::accumulate_eof_thread_call(int id, std::vector<Particle>* p, bool verbose)
@@ -3868,19 +3855,9 @@ void EmpCylSL::accumulate_thread(std::vector<Particle>& part, int mlevel, bool v
 {
   setup_accumulation();
 
-  std::vector<std::thread> t(nthrds);
- 
-  // Launch the threads
-  //
-  for (int id=0; id<nthrds; ++id) {
-    t[id] = std::thread(&EmpCylSL::accumulate_thread_call, this, id, &part, mlevel, verbose);
-  }
-
-  // Join the threads
-  //
-  for (int id=0; id<nthrds; ++id) {
-    t[id].join();
-  }
+  ThreadPool::get().run(nthrds, [&](int id) {
+    accumulate_thread_call(id, &part, mlevel, verbose);
+  });
 }
 
 
@@ -3964,19 +3941,28 @@ void EmpCylSL::accumulate(double r, double z, double phi, double mass,
   
   unsigned whch;
   if (compute and PCAVAR) {
-    whch = seq % sampT;
-    pthread_mutex_lock(&used_lock);
+    whch = seq % sampT;		// Per-thread counters: no lock needed
     numbT1[id][whch] += 1;
     massT1[id][whch] += mass;
-    pthread_mutex_unlock(&used_lock);
   }
 
   get_pot(vc[id], vs[id], r, z);
 
+  // Azimuthal harmonics by recurrence
+  //
+  double cos1 = cos(phi), sin1 = sin(phi), mcos0 = 1.0, msin0 = 0.0;
+
   for (mm=0; mm<=MMAX; mm++) {
 
-    mcos = cos(phi*mm);
-    msin = sin(phi*mm);
+    if (mm==0) {
+      mcos = 1.0;
+      msin = 0.0;
+    } else {
+      double c = mcos0*cos1 - msin0*sin1;
+      double s = msin0*cos1 + mcos0*sin1;
+      mcos = mcos0 = c;
+      msin = msin0 = s;
+    }
 
     for (int nn=0; nn<rank3; nn++) {
       double hold = norm * mass * mcos * vc[id](mm, nn);
@@ -5083,15 +5069,88 @@ void EmpCylSL::accumulated_eval(double r, double z, double phi,
   double c11 = delx1*dely1;
   
   double ccos, ssin=0.0, fac;
+
+  // Azimuthal harmonics are advanced by the angle-addition
+  // recurrence in the m loops
+  //
+  int mlast = std::min<int>(MLIM, MMAX);
+  double cos1 = cos(phi), sin1 = sin(phi);
+
+  // Interleaved tables: all fields for the four nodes are read from
+  // four contiguous blocks
+  //
+  if (packed_tables and packTab.size()) {
+
+    int stride = packStride();
+    const double *t00 = &packTab[((iy  )*(NUMX+1) + ix  )*stride];
+    const double *t10 = &packTab[((iy  )*(NUMX+1) + ix+1)*stride];
+    const double *t01 = &packTab[((iy+1)*(NUMX+1) + ix  )*stride];
+    const double *t11 = &packTab[((iy+1)*(NUMX+1) + ix+1)*stride];
+
+    ccos = 1.0;
+    ssin = 0.0;
+
+    for (int mm=0; mm<=mlast; mm++) {
+
+      if (mm) {
+	double c = ccos*cos1 - ssin*sin1;
+	ssin     = ssin*cos1 + ccos*sin1;
+	ccos     = c;
+      }
+
+      if (mm < MMIN) continue;
+    
+      // Suppress odd M terms?
+      if (EVEN_M && (mm/2)*2 != mm) continue;
+
+      for (int n=std::max<int>(0, NMIN); n<std::min<int>(NLIM, rank3); n++) {
+
+	int o  = packOffset(mm, n);
+	int nf = mm ? packFields : packFields/2;
+	double v[packFields];
+	for (int f=0; f<nf; f++)
+	  v[f] =
+	    t00[o+f] * c00 + t10[o+f] * c10 + t01[o+f] * c01 + t11[o+f] * c11;
+
+	fac = accum_cos[mm][n] * ccos;
+
+	p  += fac * v[0];
+	fr += fac * v[1];
+	fz += fac * v[2];
+	fp += accum_cos[mm][n] * ssin * mm * v[0];
+
+	if (mm) {
+	  fac = accum_sin[mm][n] * ssin;
+
+	  p  += fac * v[3];
+	  fr += fac * v[4];
+	  fz += fac * v[5];
+	  fp -= accum_sin[mm][n] * ccos * mm * v[3];
+	}
+      }
+
+      if (mm==0) p0 = p;
+    }
+
+    return;
+  }
   
-  for (int mm=std::max<int>(0, MMIN); mm<=std::min<int>(MLIM, MMAX); mm++) {
+  ccos = 1.0;
+  ssin = 0.0;
+
+  for (int mm=0; mm<=mlast; mm++) {
+
+    if (mm) {
+      double c = ccos*cos1 - ssin*sin1;
+      ssin     = ssin*cos1 + ccos*sin1;
+      ccos     = c;
+    }
+
+    if (mm < MMIN) continue;
     
     // Suppress odd M terms?
     if (EVEN_M && (mm/2)*2 != mm) continue;
 
-    ccos = cos(phi*mm);
-    ssin = sin(phi*mm);
-
     for (int n=std::max<int>(0, NMIN); n<std::min<int>(NLIM, rank3); n++) {
       
       fac = accum_cos[mm][n] * ccos;
@@ -5180,6 +5239,37 @@ void EmpCylSL::accumulated_eval(double r, double z, double phi,
 }
 
 
+void EmpCylSL::pack_tables()
+{
+  packTab.clear();
+
+  if (not packed_tables) return;
+
+  int stride = packStride();
+
+  packTab.resize((NUMX+1)*(NUMY+1)*stride);
+
+  for (int iy=0; iy<=NUMY; iy++) {
+    for (int ix=0; ix<=NUMX; ix++) {
+      double *t = &packTab[(iy*(NUMX+1) + ix)*stride];
+      for (int mm=0; mm<=MMAX; mm++) {
+	for (int n=0; n<rank3; n++) {
+	  int o = packOffset(mm, n);
+	  t[o+0] = potC   [mm][n](ix, iy);
+	  t[o+1] = rforceC[mm][n](ix, iy);
+	  t[o+2] = zforceC[mm][n](ix, iy);
+	  if (mm) {
+	    t[o+3] = potS   [mm][n](ix, iy);
+	    t[o+4] = rforceS[mm][n](ix, iy);
+	    t[o+5] = zforceS[mm][n](ix, iy);
+	  }
+	}
+      }
+    }
+  }
+}
+
+
 double EmpCylSL::accumulated_dens_eval(double r, double z, double phi, 
 				       double& d0)
 {
@@ -80,7 +80,7 @@ Particle::Particle(const Particle &p)
 }
 
 
-void Particle::readBinary(unsigned rsize, bool indexing, int seq, 
+void Particle::readBinary(unsigned rsize, bool indexing, unsigned long seq, 
 			  std::istream *in)
 {
   //
@@ -466,7 +466,7 @@ int Particle::writeBinaryMPI(char *buf, unsigned rsize, bool indexing)
 }
 
 
-void Particle::readAscii(bool indexing, int seq, std::istream* fin)
+void Particle::readAscii(bool indexing, unsigned long seq, std::istream* fin)
 {
   //
   // Character array for file reading
@@ -1039,8 +1039,16 @@ namespace PR {
   const Particle* PSPout::firstParticle()
   {
     pcount = 0;
-    
-    in.seekg(cur->pspos);
+
+    if (blocked) {
+      // Seek directly to the first record for this process
+      //
+      blockRange();
+      pcount = pfirst;
+      in.seekg(cur->pspos + static_cast<std::streamoff>(pfirst*recordSize()));
+    } else {
+      in.seekg(cur->pspos);
+    }
     
     return nextParticle();
   }
@@ -1048,6 +1056,20 @@ namespace PR {
   const Particle *PSPout::nextParticle()
   {
     badstatus(in);		// DEBUG
+
+    // Read the block for this process
+    // -------------------------------
+    if (blocked) {
+      if (pcount >= plast) return 0;
+
+      if (spos->r_size == 4) {
+	fpart.read(in, pcount++, spos);
+	return static_cast<Particle*>(&fpart);
+      } else {
+	dpart.read(in, pcount++, spos);
+	return static_cast<Particle*>(&dpart);
+      }
+    }
     
     // Stagger on first read
     // ---------------------
@@ -1102,6 +1124,22 @@ namespace PR {
     
     // Open next file in sequence
     openNextBlob();
+
+    // Skip whole blobs before the first record for this process and
+    // seek to the record in the blob that holds it
+    //
+    if (blocked) {
+      blockRange();
+
+      while (pcount + N <= pfirst and fit != spos->nparts.end()) {
+	pcount += N;
+	openNextBlob();
+      }
+
+      fcount = pfirst - pcount;
+      pcount = pfirst;
+      in.seekg(fcount*recordSize(), std::ios::cur);
+    }
     
     return nextParticle();
   }
@@ -1145,6 +1183,23 @@ namespace PR {
   const Particle* PSPspl::nextParticle()
   {
     badstatus(in);		// DEBUG
+
+    // Read the block for this process
+    // -------------------------------
+    if (blocked) {
+      if (pcount >= plast) return 0;
+
+      if (fcount==N) openNextBlob();
+
+      fcount++;
+      if (spos->r_size == 4) {
+	fpart.read(in, pcount++, spos);
+	return static_cast<Particle*>(&fpart);
+      } else {
+	dpart.read(in, pcount++, spos);
+	return static_cast<Particle*>(&dpart);
+      }
+    }
     
     // Stagger on first read
     // ---------------------
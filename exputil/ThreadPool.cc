@@ -0,0 +1,342 @@
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <set>
+
+#include <pthread.h>
+#include <dirent.h>
+#include <sched.h>
+
+#include <config_exp.h>
+
+#ifdef HAVE_OMP_H
+#include <omp.h>
+#endif
+
+#include <libvars.H>
+#include <ThreadPool.H>
+
+// True on pool threads (including the caller during a pass) to
+// serialize nested passes
+//
+static thread_local bool inPool = false;
+
+ThreadPool& ThreadPool::get()
+{
+  // exp sets nthrds from its configuration; elsewhere nthrds keeps
+  // its default of 1 so use the OpenMP limit instead
+  //
+  int n = __EXP__::nthrds;
+#ifdef HAVE_OMP_H
+  if (not __EXP__::exp_runtime) n = omp_get_max_threads();
+#endif
+
+  static ThreadPool pool(std::max<int>(n, 1),
+			 __EXP__::exp_runtime and __EXP__::pinthreads);
+  return pool;
+}
+
+ThreadPool::ThreadPool(int n, bool pinned) :
+  task(0), generation(0), pending(0), quit(false), bound(pinned)
+{
+  if (pinned) pin(0);
+
+#ifdef HAVE_OMP_H
+  // Bind OpenMP thread i to the CPU of pool thread i.  The team size
+  // is left to the caller (exp sets it to nthrds at startup).
+  //
+  if (pinned) {
+#pragma omp parallel
+    pin(omp_get_thread_num());
+  }
+#endif
+
+  for (int i=1; i<n; i++) {
+    workers.emplace_back([this, i, pinned]() {
+      if (pinned) pin(i);
+      inPool = true;
+      loop(i);
+    });
+  }
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    quit = true;
+    generation++;
+  }
+  cv_go.notify_all();
+
+  for (auto & t : workers) t.join();
+}
+
+void ThreadPool::pin(int id)
+{
+  cpu_set_t mask;
+  if (sched_getaffinity(0, sizeof(cpu_set_t), &mask)) return;
+
+  int ncpu = CPU_COUNT(&mask);
+  if (ncpu==0) return;
+
+  // The (id mod ncpu)-th CPU in the mask
+  //
+  int want = id % ncpu, cnt = 0;
+  for (int c=0; c<CPU_SETSIZE; c++) {
+    if (not CPU_ISSET(c, &mask)) continue;
+    if (cnt++ == want) {
+      cpu_set_t one;
+      CPU_ZERO(&one);
+      CPU_SET(c, &one);
+      pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &one);
+      return;
+    }
+  }
+}
+
+void ThreadPool::execute(int id)
+{
+  try {
+    (*task)(id);
+  }
+  catch (...) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (not error) error = std::current_exception();
+  }
+}
+
+void ThreadPool::loop(int id)
+{
+  unsigned long seen = 0;
+
+  while (true) {
+
+    // Spin briefly for the next pass before sleeping
+    //
+    for (int k=0; k<4000 and generation.load(std::memory_order_acquire)==seen; k++)
+      std::this_thread::yield();
+
+    {
+      std::unique_lock<std::mutex> lock(mtx);
+      cv_go.wait(lock, [&]{ return generation.load()!=seen; });
+      seen = generation.load();
+      if (quit) return;
+    }
+
+    execute(id);
+
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      if (--pending == 0) cv_done.notify_one();
+    }
+  }
+}
+
+void ThreadPool::run(const std::function<void(int)>& f)
+{
+  // Serial execution for a single thread, a nested pass or a pass
+  // started while another thread owns the pool
+  //
+  std::unique_lock<std::mutex> owner(busy, std::try_to_lock);
+
+  if (workers.empty() or inPool or not owner.owns_lock()) {
+    for (int i=0; i<size(); i++) f(i);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    task    = &f;
+    pending = workers.size();
+    error   = nullptr;
+    generation++;
+  }
+  cv_go.notify_all();
+
+  inPool = true;
+  execute(0);
+  inPool = false;
+
+  {
+    std::unique_lock<std::mutex> lock(mtx);
+    cv_done.wait(lock, [&]{ return pending==0; });
+    task = 0;
+  }
+
+  if (error) std::rethrow_exception(error);
+}
+
+void ThreadPool::run(int n, const std::function<void(int)>& f)
+{
+  int nt = size();
+  run([&f, n, nt](int k) { for (int id=k; id<n; id+=nt) f(id); });
+}
+
+// NUMA node of a CPU from sysfs or -1 if unknown
+//
+static int cpuNode(int cpu)
+{
+  std::string dir = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+
+  int node = -1;
+  if (DIR* d = opendir(dir.c_str())) {
+    while (struct dirent* e = readdir(d)) {
+      std::string name(e->d_name);
+      if (name.compare(0, 4, "node")==0 and name.size()>4) {
+	node = atoi(name.c_str()+4);
+	break;
+      }
+    }
+    closedir(d);
+  }
+
+  return node;
+}
+
+// Compact list of integers, e.g. "0-31,64-95"
+//
+static std::string ranges(const std::set<int>& v)
+{
+  std::ostringstream sout;
+  auto it = v.begin();
+  while (it != v.end()) {
+    int a = *it, b = a;
+    while (++it != v.end() and *it == b+1) b++;
+    if (sout.tellp() > 0) sout << ",";
+    sout << a;
+    if (b>a) sout << "-" << b;
+  }
+  return sout.str();
+}
+
+void ThreadPool::report()
+{
+  // CPUs each pool thread may run on
+  //
+  std::vector<std::set<int>> cpus(size());
+
+  run([&cpus](int id) {
+    cpu_set_t mask;
+    if (pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &mask)==0) {
+      for (int c=0; c<CPU_SETSIZE; c++)
+	if (CPU_ISSET(c, &mask)) cpus[id].insert(c);
+    }
+  });
+
+  std::set<int> all, nodes;
+  bool shared = false;
+  for (auto & v : cpus) {
+    if (bound) {
+      for (auto c : v) if (all.count(c)) shared = true;
+    }
+    all.insert(v.begin(), v.end());
+  }
+  for (auto c : all) nodes.insert(cpuNode(c));
+
+  int myid, numprocs, len;
+  MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+  MPI_Comm_size(MPI_COMM_WORLD, &numprocs);
+
+  char host[MPI_MAX_PROCESSOR_NAME];
+  MPI_Get_processor_name(host, &len);
+
+  std::ostringstream sout;
+  sout << "Process " << myid << " on " << host << ": " << size()
+       << (bound ? " pinned" : " unpinned") << " threads, "
+#ifdef HAVE_OMP_H
+       << omp_get_max_threads() << " OpenMP threads, "
+#endif
+       << "CPUs " << ranges(all) << ", NUMA node(s) "
+       << (nodes.count(-1) ? std::string("unknown") : ranges(nodes));
+  if (shared) sout << " [threads share CPUs]";
+  if (bound and size()>1) {
+    sout << std::endl << "  thread->CPU:";
+    for (int i=0; i<size(); i++)
+      sout << " " << i << "->" << ranges(cpus[i]);
+  }
+  sout << std::endl;
+
+  // Gather the lines on the root in rank order
+  //
+  std::string buf = sout.str();
+  len = buf.size();
+
+  std::vector<int> lens(numprocs), disp(numprocs, 0);
+  MPI_Gather(&len, 1, MPI_INT, lens.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+  int total = 0;
+  if (myid==0) {
+    for (int i=0; i<numprocs; i++) { disp[i] = total; total += lens[i]; }
+  }
+
+  std::vector<char> lines(total+1, 0);
+  MPI_Gatherv(buf.data(), len, MPI_CHAR, lines.data(), lens.data(),
+	      disp.data(), MPI_CHAR, 0, MPI_COMM_WORLD);
+
+  if (myid==0) {
+    std::cout << std::string(72, '-') << std::endl
+	      << "Thread binding" << std::endl
+	      << std::string(72, '-') << std::endl
+	      << lines.data()
+	      << std::string(72, '-') << std::endl;
+  }
+}
+
+
+void WorkRanges::reset(unsigned n, int nthrds)
+{
+  if (static_cast<int>(slot.size()) != nthrds)
+    slot = std::vector<Slot>(nthrds);
+
+  // Small enough to balance, large enough to amortize the atomics
+  //
+  chunk = std::max<int>(16, n/(16*nthrds));
+
+  for (int i=0; i<nthrds; i++) {
+    unsigned beg = static_cast<unsigned long>(n)*i/nthrds;
+    unsigned end = static_cast<unsigned long>(n)*(i+1)/nthrds;
+    slot[i].r.store(pack(beg, end), std::memory_order_relaxed);
+  }
+}
+
+bool WorkRanges::next(int id, int& beg, int& end)
+{
+  int nt = slot.size();
+
+  // Own slice: take from the front
+  //
+  unsigned long cur = slot[id].r.load(std::memory_order_relaxed);
+  while (true) {
+    unsigned b = cur >> 32, e = cur & 0xffffffffUL;
+    if (b >= e) break;
+    unsigned nb = std::min<unsigned>(e, b + chunk);
+    if (slot[id].r.compare_exchange_weak(cur, pack(nb, e))) {
+      beg = b;
+      end = nb;
+      return true;
+    }
+  }
+
+  // Steal from the back of the other slices
+  //
+  for (int k=1; k<nt; k++) {
+    int v = (id + k) % nt;
+    cur = slot[v].r.load(std::memory_order_relaxed);
+    while (true) {
+      unsigned b = cur >> 32, e = cur & 0xffffffffUL;
+      if (b >= e) break;
+      unsigned ne = e - std::min<unsigned>(e - b, chunk);
+      if (slot[v].r.compare_exchange_weak(cur, pack(b, ne))) {
+	beg = ne;
+	end = e;
+	return true;
+      }
+    }
+  }
+
+  return false;
+}
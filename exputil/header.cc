@@ -6,7 +6,10 @@ int ComponentHeader::defaultInfoSize = 1024;
 
 bool ComponentHeader::write(ostream *out)
 {
-  out->write((const char *)&nbod,  sizeof(int));
+  int nbod32 = wideCount() ? -1 : static_cast<int>(nbod);
+
+  out->write((const char *)&nbod32, sizeof(int));
+  if (wideCount()) out->write((const char *)&nbod, sizeof(unsigned long));
   out->write((const char *)&niatr, sizeof(int));
   out->write((const char *)&ndatr, sizeof(int));
   out->write((const char *)&ninfochar, sizeof(int));
@@ -23,8 +26,9 @@ bool ComponentHeader::write_mpi(MPI_File& out, MPI_Offset& offset)
   MPI_Status status;
   char err[MPI_MAX_ERROR_STRING];
   int len, ret;
+  int nbod32 = wideCount() ? -1 : static_cast<int>(nbod);
 
-  ret = MPI_File_write_at(out, offset, &nbod, 1, MPI_INT, &status);
+  ret = MPI_File_write_at(out, offset, &nbod32, 1, MPI_INT, &status);
 
   if (ret != MPI_SUCCESS) {
     MPI_Error_string(ret, err, &len);
@@ -35,6 +39,19 @@ bool ComponentHeader::write_mpi(MPI_File& out, MPI_Offset& offset)
 
   offset += sizeof(int);
 
+  if (wideCount()) {
+    ret = MPI_File_write_at(out, offset, &nbod, 1, MPI_UNSIGNED_LONG, &status);
+
+    if (ret != MPI_SUCCESS) {
+      MPI_Error_string(ret, err, &len);
+      std::cout << "ComponentHeader::write_mpi: " << err
+		<< " at line " << __LINE__ << std::endl;
+      return false;
+    }
+
+    offset += sizeof(unsigned long);
+  }
+
   ret = MPI_File_write_at(out, offset, &niatr, 1, MPI_INT, &status);
 
   if (ret != MPI_SUCCESS) {
@@ -84,9 +101,14 @@ bool ComponentHeader::write_mpi(MPI_File& out, MPI_Offset& offset)
 
 bool ComponentHeader::read(istream *in)
 {
-  int ninfo;
+  int ninfo, nbod32;
 
-  in->read((char *)&nbod,  sizeof(int));		if (!*in) return false;
+  in->read((char *)&nbod32, sizeof(int));		if (!*in) return false;
+  if (nbod32 < 0) {
+    in->read((char *)&nbod, sizeof(unsigned long));	if (!*in) return false;
+  } else {
+    nbod = nbod32;
+  }
   in->read((char *)&niatr, sizeof(int));		if (!*in) return false;
   in->read((char *)&ndatr, sizeof(int));		if (!*in) return false;
   in->read((char *)&ninfo, sizeof(int));		if (!*in) return false;
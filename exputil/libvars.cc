@@ -22,6 +22,12 @@ namespace __EXP__
   //! Number of POSIX threads (minimum: 1)
   int              nthrds           = 1;
 
+  //! Pin pool threads to CPUs
+  bool             pinthreads       = false;
+
+  //! Set by exp at startup
+  bool             exp_runtime      = false;
+
   //! Multistep indices
   unsigned         multistep        = 0;
 
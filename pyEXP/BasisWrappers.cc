@@ -195,6 +195,10 @@ void BasisFactoryClasses(py::module &m)
     a fixed potential model.  AccelFunc can be inherited by a native Python
     class and the evalcoefs() may be implemented in Python and passed to
     IntegrateOrbits in the same way as a native C++ class.
+    IntegrateOrbits returns every output frame in memory.  For large
+    ensembles, IntegrateOrbitsStream passes the frames to a Python
+    callback in blocks and IntegrateOrbitsH5 writes them to an HDF5 file
+    in blocks, so that only one block is held in memory.
     )";
 
   using namespace BasisClasses;
@@ -357,7 +361,26 @@ void BasisFactoryClasses(py::module &m)
 
   };
 
-  class PyBiorthBasis : public BiorthBasis
+  // Common base for the biorthogonal trampolines.  A Python subclass
+  // may override accumulate(), getFields() or the basis evaluators and
+  // these must be called serially with the GIL held: accumulation uses
+  // one thread and batch evaluation goes through getFields() one
+  // point at a time.
+  //
+  template<class B>
+  class PySerial : public B
+  {
+  public:
+    using B::B;
+
+    int accum_threads() override { return 1; }
+
+    void getFieldsBatch(const Eigen::Ref<const RowMatrixXd>& pos,
+			Eigen::Ref<RowMatrixXd> out) override
+    { BasisClasses::Basis::getFieldsBatch(pos, out); }
+  };
+
+  class PyBiorthBasis : public PySerial<BiorthBasis>
   {
   protected:
     std::vector<double> sph_eval(double r, double costh, double phi) override
@@ -392,7 +415,7 @@ void BasisFactoryClasses(py::module &m)
 
   public:
     // Inherit the constructors
-    using BasisClasses::BiorthBasis::BiorthBasis;
+    using PySerial<BiorthBasis>::PySerial;
 
     void accumulate(double x, double y, double z, double mass) override {
       PYBIND11_OVERRIDE_PURE(void, BiorthBasis, accumulate, x, y, z, mass);
@@ -412,7 +435,7 @@ void BasisFactoryClasses(py::module &m)
 
   };
 
-  class PySpherical : public Spherical
+  class PySpherical : public PySerial<Spherical>
   {
   protected:
 
@@ -448,7 +471,7 @@ void BasisFactoryClasses(py::module &m)
   public:
 
     // Inherit the constructors
-    using Spherical::Spherical;
+    using PySerial<Spherical>::PySerial;
 
     std::vector<double> getFields(double x, double y, double z) override {
       PYBIND11_OVERRIDE(std::vector<double>, Spherical, getFields, x, y, z);
@@ -473,7 +496,7 @@ void BasisFactoryClasses(py::module &m)
   };
 
 
-  class PyCylindrical : public Cylindrical
+  class PyCylindrical : public PySerial<Cylindrical>
   {
   protected:
 
@@ -496,7 +519,7 @@ void BasisFactoryClasses(py::module &m)
   public:
 
     // Inherit the constructors
-    using Cylindrical::Cylindrical;
+    using PySerial<Cylindrical>::PySerial;
 
     std::vector<double> getFields(double x, double y, double z) override {
       PYBIND11_OVERRIDE(std::vector<double>, Cylindrical, getFields, x, y, z);
@@ -517,7 +540,7 @@ void BasisFactoryClasses(py::module &m)
   };
 
 
-  class PyFlatDisk : public FlatDisk
+  class PyFlatDisk : public PySerial<FlatDisk>
   {
   protected:
 
@@ -557,7 +580,7 @@ void BasisFactoryClasses(py::module &m)
   public:
 
     // Inherit the constructors
-    using FlatDisk::FlatDisk;
+    using PySerial<FlatDisk>::PySerial;
 
     std::vector<double> getFields(double x, double y, double z) override
     {
@@ -582,7 +605,7 @@ void BasisFactoryClasses(py::module &m)
   };
 
 
-  class PySlab : public Slab
+  class PySlab : public PySerial<Slab>
   {
   protected:
 
@@ -625,7 +648,7 @@ void BasisFactoryClasses(py::module &m)
   public:
 
     // Inherit the constructors
-    using Slab::Slab;
+    using PySerial<Slab>::PySerial;
 
     std::vector<double> getFields(double x, double y, double z) override
     {
@@ -650,7 +673,7 @@ void BasisFactoryClasses(py::module &m)
   };
 
 
-  class PyCube : public Cube
+  class PyCube : public PySerial<Cube>
   {
   protected:
 
@@ -693,7 +716,7 @@ void BasisFactoryClasses(py::module &m)
   public:
 
     // Inherit the constructors
-    using Cube::Cube;
+    using PySerial<Cube>::PySerial;
 
     std::vector<double> getFields(double x, double y, double z) override
     {
@@ -898,9 +921,17 @@ void BasisFactoryClasses(py::module &m)
          -------
          CoefStruct
              the basis coefficients computed from the particles
+
+         Notes
+         -----
+         The reader is consumed in batches by a reader thread, which
+         also calls the selector if one is set, while the OpenMP threads
+         accumulate the previous batch.  The interpreter lock is released
+         for the duration of the call.
          )",
 	 py::arg("reader"), 
-	 py::arg("center") = std::vector<double>(3, 0.0))
+	 py::arg("center") = std::vector<double>(3, 0.0),
+	 py::call_guard<py::gil_scoped_release>())
     .def("createFromArray",
 	 [](BasisClasses::BiorthBasis& A, Eigen::VectorXd& mass, RowMatrixXd& pos,
 	    double time, std::vector<double> center,
@@ -1027,6 +1058,40 @@ void BasisFactoryClasses(py::module &m)
          __call__       : same getFields() but provides field labels in a tuple
          )",
 	 py::arg("x"), py::arg("y"), py::arg("z"))
+    .def("getFieldsBatch",
+	 [](BasisClasses::BiorthBasis& A,
+	    const Eigen::Ref<const RowMatrixXd>& pos)
+	 {
+	   return A.getFieldsBatch(pos);
+	 },
+	 R"(
+         Return the field evaluations for an array of cartesian
+         positions.  Each row of the returned array holds the fields
+         in the order given by getFields() for the same row of the
+         position array.  The points are evaluated in parallel using
+         OpenMP threads.
+
+         Parameters
+         ----------
+         pos : numpy.ndarray
+             an array of positions with shape (n, 3)
+
+         Returns
+         -------
+         fields: numpy.ndarray
+             an array of field values with shape (n, nfields)
+
+         Notes
+         -----
+         A C-contiguous float64 position array is used in place
+         without a copy and the returned array is handed to numpy
+         without a copy.  The GIL is released during the evaluation.
+
+         See also
+         --------
+         getFields : get fields at a single position
+         )",
+	 py::arg("pos"), py::call_guard<py::gil_scoped_release>())
     .def("getFieldsCoefs", &BasisClasses::BiorthBasis::getFieldsCoefs,
 	 R"(
          Return the field evaluations for a given cartesian position
@@ -2052,4 +2117,132 @@ void BasisFactoryClasses(py::module &m)
 	py::arg("tinit"), py::arg("tfinal"), py::arg("h"),
 	py::arg("ps"), py::arg("basiscoef"), py::arg("func"),
 	py::arg("nout")=std::numeric_limits<int>::max());
+
+  m.def("IntegrateOrbitsStream", 
+	[](double tinit, double tfinal, double h, Eigen::MatrixXd ps,
+	   std::vector<BasisClasses::BasisCoef> bfe,
+	   BasisClasses::AccelFunc& func, py::function callback,
+	   int stride, int chunk)
+	{
+	  AccelFunctor F = [&func](double t, Eigen::MatrixXd& ps, Eigen::MatrixXd& accel, BasisCoef mod)->Eigen::MatrixXd& { return func.F(t, ps, accel, mod);};
+
+	  // The frame buffer is reused so each block is copied into a
+	  // new array
+	  OrbitCallback out =
+	    [&callback](int first, const Eigen::VectorXd& T, const OrbitFrames& f)
+	    {
+	      py::gil_scoped_acquire acquire;
+	      auto d = f.dimensions();
+	      py::array_t<float> frames
+		({d[0], d[1], d[2]},
+		 {sizeof(float), d[0]*sizeof(float), d[0]*d[1]*sizeof(float)},
+		 f.data());
+	      callback(first, T, frames);
+	    };
+
+	  return BasisClasses::IntegrateOrbitsStream(tinit, tfinal, h, ps, bfe,
+						     F, out, stride, chunk);
+	},
+	R"(
+        Compute particle orbits in gravitational field from the bases and
+        pass the output to a callback in blocks
+
+        This is IntegrateOrbits for ensembles whose full output does not
+        fit in memory.  The output frames are passed to the callback in
+        blocks of at most 'chunk' frames as they are computed.  The
+        drifts, kicks and field evaluations are split over OpenMP threads
+        and the coefficients are interpolated once per step for all
+        orbits.
+
+        Parameters
+        ----------
+        tinit : float
+            the intial time
+        tfinal : float
+            the final time
+        h : float
+            the integration step size
+        ps : numpy.ndarray
+            an n x 6 table of phase-space initial conditions
+        bfe : list(BasisCoef)
+            a list of BFE coefficients used to generate the gravitational 
+            field
+        func : AccelFunctor
+            the force function
+        callback : function
+            called as callback(first, times, frames) with the index of the
+            first frame in the block, the block's times and an n x 6 x m
+            array of the block's phase-space frames
+        nout : int 
+            the number of output intervals
+        chunk : int
+            the maximum number of frames per block.  The default bounds
+            the block to about 256 MB.
+
+        Returns
+        -------
+        int
+            the number of output frames
+        )",
+	py::arg("tinit"), py::arg("tfinal"), py::arg("h"),
+	py::arg("ps"), py::arg("basiscoef"), py::arg("func"),
+	py::arg("callback"),
+	py::arg("nout")=std::numeric_limits<int>::max(),
+	py::arg("chunk")=0,
+	py::call_guard<py::gil_scoped_release>());
+
+  m.def("IntegrateOrbitsH5", 
+	[](double tinit, double tfinal, double h, Eigen::MatrixXd ps,
+	   std::vector<BasisClasses::BasisCoef> bfe,
+	   BasisClasses::AccelFunc& func, const std::string& file,
+	   int stride, int chunk)
+	{
+	  AccelFunctor F = [&func](double t, Eigen::MatrixXd& ps, Eigen::MatrixXd& accel, BasisCoef mod)->Eigen::MatrixXd& { return func.F(t, ps, accel, mod);};
+
+	  return BasisClasses::IntegrateOrbitsH5(tinit, tfinal, h, ps, bfe,
+						 F, file, stride, chunk);
+	},
+	R"(
+        Compute particle orbits in gravitational field from the bases and
+        write them to an HDF5 file
+
+        This is IntegrateOrbits for ensembles whose full output does not
+        fit in memory.  The output frames are written in blocks of at
+        most 'chunk' frames as they are computed.  The file holds the
+        datasets 'times' with shape (nout) and 'orbits' with shape
+        (nout, 6, n), and the attributes 'tinit', 'tfinal' and 'h'.
+
+        Parameters
+        ----------
+        tinit : float
+            the intial time
+        tfinal : float
+            the final time
+        h : float
+            the integration step size
+        ps : numpy.ndarray
+            an n x 6 table of phase-space initial conditions
+        bfe : list(BasisCoef)
+            a list of BFE coefficients used to generate the gravitational 
+            field
+        func : AccelFunctor
+            the force function
+        file : str
+            the HDF5 file name; an existing file is overwritten
+        nout : int 
+            the number of output intervals
+        chunk : int
+            the maximum number of frames per block.  The default bounds
+            the block to about 256 MB.
+
+        Returns
+        -------
+        int
+            the number of output frames
+        )",
+	py::arg("tinit"), py::arg("tfinal"), py::arg("h"),
+	py::arg("ps"), py::arg("basiscoef"), py::arg("func"),
+	py::arg("file"),
+	py::arg("nout")=std::numeric_limits<int>::max(),
+	py::arg("chunk")=0);
 }
@@ -972,6 +972,34 @@ void CoefficientClasses(py::module &m) {
             -----
             You will get a runtime error if the H5 filename does not exist
             )",py::arg("filename"))
+    .def("setH5Layout",
+            &CoefClasses::Coefs::setH5Layout,
+            R"(
+            Select the HDF5 layout used by WriteH5Coefs
+
+            Parameters
+            ----------
+            series : bool
+                use the chunked time-series layout: one extendible
+                (time x coefficient) dataset and a time vector rather
+                than one group per snapshot
+            chunk : int, default=256
+                number of snapshots per HDF5 chunk
+            deflate : int, default=0
+                gzip compression level (0 for none)
+            shuffle : bool, default=False
+                enable the HDF5 shuffle filter
+
+            Returns
+            -------
+            None
+
+            Notes
+            -----
+            ExtendH5Coefs always follows the layout of the existing file.
+            )",
+            py::arg("series"), py::arg("chunk")=256,
+            py::arg("deflate")=0, py::arg("shuffle")=false)
     .def("Power",
              &CoefClasses::Coefs::Power,
              R"(
@@ -1100,6 +1128,34 @@ void CoefficientClasses(py::module &m) {
             py::arg("file"), py::arg("stride")=1,
             py::arg("tmin")=-std::numeric_limits<double>::max(),
             py::arg("tmax")= std::numeric_limits<double>::max())
+    .def_static("ReadH5Block", &CoefClasses::Coefs::ReadH5Block,
+              R"(
+              Read a block of a time-series HDF5 coefficient file
+              without building the coefficient database
+
+              Parameters
+              ----------
+              file : str
+                  the file path
+              tmin : float, default=-inf
+                   minimum time value
+              tmax : float, default=inf
+                   maximum time value
+              cmin : int, default=0
+                   first coefficient index
+              cmax : int, default=all
+                   one past the last coefficient index
+
+            Returns
+            -------
+            tuple(list(float), numpy.ndarray)
+                the times and the coefficient block with times as rows
+            )",
+            py::arg("file"),
+            py::arg("tmin")=-std::numeric_limits<double>::max(),
+            py::arg("tmax")= std::numeric_limits<double>::max(),
+            py::arg("cmin")=0,
+            py::arg("cmax")=std::numeric_limits<size_t>::max())
     .def_static("makecoefs", &CoefClasses::Coefs::makecoefs,
 		R"(
                 make a new coefficient container instance compatible
@@ -1726,4 +1782,76 @@ void CoefficientClasses(py::module &m) {
          numpy.ndarray
              2-dimensional numpy array containing the data table
          )");
+
+  py::class_<CoefClasses::LazyCoefs, std::shared_ptr<CoefClasses::LazyCoefs>, CoefClasses::Coefs>
+    (m, "LazyCoefs", "Read-only, on-demand view of a time-series HDF5 coefficient file")
+    .def(py::init<const std::string&, size_t, bool>(),
+	 R"(
+         Open a coefficient file written with the time-series layout
+         without reading the coefficients
+
+         Parameters
+         ----------
+         file : str
+             the HDF5 coefficient file
+         cache : int, default=64
+             maximum number of snapshots kept in memory
+         verbose : bool, default=False
+             display verbose information
+
+         Returns
+         -------
+         LazyCoefs instance
+
+         Notes
+         -----
+         Snapshots are read when requested by getCoefStruct or
+         getData and kept in a least-recently-used cache.  Power()
+         is computed in blocks.  Use Slice() to obtain an in-memory
+         coefficient container for a time window.
+         )", py::arg("file"), py::arg("cache")=64, py::arg("verbose")=false)
+    .def("Slice", &CoefClasses::LazyCoefs::Slice,
+	 R"(
+         Read the snapshots in a time window into an in-memory
+         coefficient container
+
+         Parameters
+         ----------
+         tmin : float, default=-inf
+             minimum time
+         tmax : float, default=inf
+             maximum time
+         stride : int, default=1
+             keep every stride-th snapshot
+
+         Returns
+         -------
+         Coefs
+             the coefficient container of the native type
+         )",
+	 py::arg("tmin")=-std::numeric_limits<double>::max(),
+	 py::arg("tmax")= std::numeric_limits<double>::max(),
+	 py::arg("stride")=1)
+    .def("setCacheSize", &CoefClasses::LazyCoefs::setCacheSize,
+	 R"(
+         Set the maximum number of cached snapshots
+
+         Parameters
+         ----------
+         n : int
+             the number of snapshots
+
+         Returns
+         -------
+         None
+         )", py::arg("n"))
+    .def("getCacheSize", &CoefClasses::LazyCoefs::getCacheSize,
+	 R"(
+         Get the maximum number of cached snapshots
+
+         Returns
+         -------
+         int
+             the number of snapshots
+         )");
 }
@@ -459,7 +459,13 @@ void ParticleReaderClasses(py::module &m) {
 	 "Print a summary of list of extents, center of mass, and "
 	 "other global quantities for this snapshopt.  This requires "
 	 "a read pass and may be time consuming",
-	 py::arg("stats")=true, py::arg("timeonly")=false);
+	 py::arg("stats")=true, py::arg("timeonly")=false)
+    .def("setBlocked",      &PSP::setBlocked,
+	 "Partition the particles among MPI processes in contiguous "
+	 "blocks, each process seeking directly to its own records "
+	 "(True, the default), or round robin with every process "
+	 "passing through the entire file (False)",
+	 py::arg("blocked")=true);
 
 
   py::class_<PSPout, std::shared_ptr<PSPout>, PyPSPout, PSP>(m, "PSPout")
@@ -0,0 +1,162 @@
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <cerrno>
+#include <functional>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "EXPException.H"
+#include "global.H"
+#include "AsyncWriter.H"
+
+AsyncWriter::AsyncWriter(size_t budget) : cur(0), budget(budget)
+{
+  job[0].failed = job[1].failed = false;
+}
+
+AsyncWriter::~AsyncWriter()
+{
+  // Callbacks may be collective so they are not safe to call here
+  //
+  job[0].done = job[1].done = nullptr;
+  wait();
+}
+
+void AsyncWriter::begin()
+{
+  Job& j = job[cur];
+  j.files.clear();
+  j.segs.clear();
+  j.data.clear();
+  j.error.clear();
+  j.failed = false;
+  j.done   = nullptr;
+}
+
+int AsyncWriter::file(const std::string& name, bool create)
+{
+  // Truncate here, by the calling thread, so that overflow writes and
+  // the I/O thread can both open without O_TRUNC
+  //
+  if (create) {
+    int fd = ::open(name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+      std::ostringstream sout;
+      sout << "AsyncWriter: can't create file <" << name << ">: "
+	   << strerror(errno);
+      throw GenericError(sout.str(), __FILE__, __LINE__, 33, false);
+    }
+    ::close(fd);
+  }
+
+  job[cur].files.push_back(name);
+  return job[cur].files.size() - 1;
+}
+
+char* AsyncWriter::reserve(int id, size_t offset, size_t n)
+{
+  Job& j = job[cur];
+
+  // Over budget: drain what has been staged so far
+  //
+  if (j.data.size() + n > budget and j.data.size()) {
+    write(j);
+    if (j.error.size()) {
+      std::cerr << "[" << myid << "] " << j.error << std::endl;
+      j.error.clear();
+      j.failed = true;
+    }
+  }
+
+  size_t pos = j.data.size();
+  j.data.resize(pos + n);
+
+  // Extend the last segment if this range is contiguous with it
+  //
+  if (j.segs.size()) {
+    Segment& s = j.segs.back();
+    if (s.file == id and s.offset + s.len == offset and s.pos + s.len == pos) {
+      s.len += n;
+      return &j.data[pos];
+    }
+  }
+
+  j.segs.push_back({id, offset, pos, n});
+
+  return &j.data[pos];
+}
+
+void AsyncWriter::write(Job& j)
+{
+  std::vector<int> fds(j.files.size(), -1);
+
+  for (auto & s : j.segs) {
+
+    if (fds[s.file] < 0) {
+      fds[s.file] = ::open(j.files[s.file].c_str(), O_WRONLY);
+      if (fds[s.file] < 0) {
+	j.error = "AsyncWriter: can't open file <" + j.files[s.file] + ">: " +
+	  strerror(errno);
+	break;
+      }
+    }
+
+    const char* buf = &j.data[s.pos];
+    size_t left = s.len;
+    off_t  off  = s.offset;
+
+    while (left) {
+      ssize_t ret = ::pwrite(fds[s.file], buf, left, off);
+      if (ret < 0) {
+	if (errno == EINTR) continue;
+	j.error = "AsyncWriter: error writing file <" + j.files[s.file] +
+	  ">: " + strerror(errno);
+	break;
+      }
+      buf  += ret;
+      off  += ret;
+      left -= ret;
+    }
+
+    if (j.error.size()) break;
+  }
+
+  for (auto fd : fds) if (fd >= 0) ::close(fd);
+
+  // Release the staged data but keep the capacity for the next dump
+  //
+  j.segs.clear();
+  j.data.clear();
+}
+
+void AsyncWriter::commit(std::function<void(bool)> done)
+{
+  wait();
+
+  job[cur].done = done;
+  worker = std::thread(&AsyncWriter::write, std::ref(job[cur]));
+
+  cur = 1 - cur;
+}
+
+void AsyncWriter::wait()
+{
+  if (worker.joinable()) {
+    worker.join();
+
+    Job& j = job[1-cur];
+    if (j.error.size()) {
+      std::cerr << "[" << myid << "] " << j.error << std::endl;
+      j.error.clear();
+      j.failed = true;
+    }
+
+    if (j.done) {
+      auto done = std::move(j.done);
+      j.done = nullptr;
+      done(not j.failed);
+    }
+  }
+}
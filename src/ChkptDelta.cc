@@ -0,0 +1,578 @@
+#include <cstdio>
+#include <cmath>
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <cstring>
+
+#include <unistd.h>		// For unlink
+
+#include "expand.H"
+#include <global.H>
+
+#include <ChkptDelta.H>
+
+ChkptDelta::ChkptDelta(const std::string& basefile) :
+  basefile(basefile), tbase(0.0), seq(-1)
+{
+}
+
+size_t ChkptDelta::attribHash(const Particle& p)
+{
+  // FNV-1a over the mass and attribute bytes
+  //
+  size_t h = 14695981039346656037UL;
+
+  auto add = [&h](const void* v, size_t n) {
+    const unsigned char* c = static_cast<const unsigned char*>(v);
+    for (size_t i=0; i<n; i++) {
+      h ^= c[i];
+      h *= 1099511628211UL;
+    }
+  };
+
+  add(&p.mass, sizeof(double));
+  if (p.iattrib.size()) add(p.iattrib.data(), sizeof(int)*p.iattrib.size());
+  if (p.dattrib.size()) add(p.dattrib.data(), sizeof(double)*p.dattrib.size());
+
+  return h;
+}
+
+// Pack the frame state of a component: the center, the COM, COV and
+// acceleration frames and the EJ orientation state
+//
+static void packFrame(Component* c, std::vector<double>& f)
+{
+  f.clear();
+  for (int k=0; k<3; k++) f.push_back(c->center[k]);
+  for (int k=0; k<3; k++) f.push_back(c->com0[k]);
+  for (int k=0; k<3; k++) f.push_back(c->cov0[k]);
+  for (int k=0; k<3; k++) f.push_back(c->acc0[k]);
+  if (c->orient) c->orient->pack(f);
+}
+
+static void unpackFrame(Component* c, const std::vector<double>& f)
+{
+  const double* p = f.data();
+  for (int k=0; k<3; k++) c->center[k] = *p++;
+  for (int k=0; k<3; k++) c->com0[k]   = *p++;
+  for (int k=0; k<3; k++) c->cov0[k]   = *p++;
+  for (int k=0; k<3; k++) c->acc0[k]   = *p++;
+  if (c->orient and p < f.data() + f.size()) c->orient->unpack(p);
+}
+
+bool ChkptDelta::ready()
+{
+  if (nbase.size() != comp->components.size()) return false;
+
+  int i = 0;
+  for (auto c : comp->components) {
+    if (c->CurTotal() != nbase[i++]) return false;
+  }
+
+  return true;
+}
+
+void ChkptDelta::write_manifest(double tdelta)
+{
+  std::string name = manifestName(basefile), temp = name + ".tmp";
+
+  std::ofstream out(temp);
+  if (out) {
+    out << std::setprecision(17);
+    out << "# EXP incremental checkpoint manifest" << std::endl
+	<< "base "  << tbase << std::endl;
+    if (seq>=0)
+      out << "delta " << seq << " " << tdelta << " " << numprocs << std::endl;
+    out.close();
+  }
+
+  if (out.fail() or rename(temp.c_str(), name.c_str())) {
+    std::cout << "ChkptDelta: error writing manifest <" << name << ">"
+	      << std::endl;
+  }
+}
+
+void ChkptDelta::remove(int n)
+{
+  if (n<0) return;
+
+  std::string file = deltaName(basefile, n, myid);
+  if (unlink(file.c_str()) and VERBOSE>5) perror("ChkptDelta::remove()");
+}
+
+void ChkptDelta::base()
+{
+  tbase = tnow;
+
+  nbase.clear();
+  hash.resize(comp->components.size());
+
+  int i = 0;
+  for (auto c : comp->components) {
+#ifdef HAVE_LIBCUDA
+    if (use_cuda) {
+      if (c->force->cudaAware() and not comp->fetched[c]) {
+	comp->fetched[c] = true;
+	c->CudaToParticles();
+      }
+    }
+#endif
+    nbase.push_back(c->CurTotal());
+
+    auto & h = hash[i++];
+    h.clear();
+    h.reserve(c->Number());
+    for (auto & p : c->Particles()) h[p.first] = attribHash(*p.second);
+  }
+
+  // Deltas from the previous base are no longer valid
+  //
+  int prev = seq;
+  seq = -1;
+
+  if (myid==0) write_manifest(tbase);
+
+  MPI_Barrier(MPI_COMM_WORLD);
+
+  remove(prev);
+}
+
+void ChkptDelta::write()
+{
+  int next = seq + 1;
+
+  std::string file = deltaName(basefile, next, myid);
+  std::ofstream out(file, std::ios::binary);
+
+  int nOK = out.good() ? 0 : 1;
+
+  if (not nOK) {
+    int ncomp = comp->components.size();
+    unsigned long mgc = magic;
+    out.write((const char*)&mgc,   sizeof(unsigned long));
+    out.write((const char*)&tnow,  sizeof(double));
+    out.write((const char*)&ncomp, sizeof(int));
+
+    std::vector<char> buf;
+    std::vector<double> frame;
+    int i = 0;
+
+    for (auto c : comp->components) {
+#ifdef HAVE_LIBCUDA
+      if (use_cuda) {
+	if (c->force->cudaAware() and not comp->fetched[c]) {
+	  comp->fetched[c] = true;
+	  c->CudaToParticles();
+	}
+      }
+#endif
+      unsigned long count = c->Number();
+      int ni = c->niattrib, nd = c->ndattrib;
+
+      out.write((const char*)&count, sizeof(unsigned long));
+      out.write((const char*)&ni,    sizeof(int));
+      out.write((const char*)&nd,    sizeof(int));
+
+      // The frame state is the same on all processes so only the
+      // root records it
+      //
+      frame.clear();
+      if (myid==0) packFrame(c, frame);
+
+      int nf = frame.size();
+      out.write((const char*)&nf, sizeof(int));
+      if (nf) out.write((const char*)frame.data(), nf*sizeof(double));
+
+      const size_t fixed = sizeof(unsigned long) + sizeof(unsigned) +
+	sizeof(unsigned char) + 6*sizeof(double);
+      const size_t extra = sizeof(double) + ni*sizeof(int) + nd*sizeof(double);
+
+      auto & h = hash[i++];
+
+      // Serialize in blocks to bound the buffer size
+      //
+      const size_t block = 16384;
+      buf.reserve(block*(fixed + extra));
+
+      auto it = c->Particles().begin(), end = c->Particles().end();
+      while (it != end) {
+	buf.clear();
+	for (size_t k=0; k<block and it!=end; k++, it++) {
+	  Particle* p = it->second.get();
+
+	  auto jt = h.find(p->indx);
+	  unsigned char flag = (jt==h.end() or jt->second != attribHash(*p)) ? 1 : 0;
+
+	  size_t pos = buf.size();
+	  buf.resize(pos + fixed + (flag ? extra : 0));
+	  char* b = &buf[pos];
+
+	  memcpy(b, &p->indx,  sizeof(unsigned long)); b += sizeof(unsigned long);
+	  memcpy(b, &p->level, sizeof(unsigned));      b += sizeof(unsigned);
+	  memcpy(b, &flag,     sizeof(unsigned char)); b += sizeof(unsigned char);
+	  memcpy(b, p->pos,  3*sizeof(double));        b += 3*sizeof(double);
+	  memcpy(b, p->vel,  3*sizeof(double));        b += 3*sizeof(double);
+
+	  if (flag) {
+	    memcpy(b, &p->mass, sizeof(double)); b += sizeof(double);
+	    if (ni) memcpy(b, p->iattrib.data(), ni*sizeof(int));
+	    b += ni*sizeof(int);
+	    if (nd) memcpy(b, p->dattrib.data(), nd*sizeof(double));
+	  }
+	}
+	out.write(buf.data(), buf.size());
+      }
+    }
+
+    out.close();
+    if (out.fail()) nOK = 1;
+  }
+
+  MPI_Allreduce(MPI_IN_PLACE, &nOK, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+
+  if (nOK) {
+    // Leave the manifest pointing at the previous delta
+    //
+    remove(next);
+    throw std::runtime_error("ChkptDelta::write: error writing delta <" +
+			     file + ">");
+  }
+
+  // All delta files are complete: advance the manifest and remove
+  // the previous delta
+  //
+  int prev = seq;
+  seq = next;
+
+  if (myid==0) write_manifest(tnow);
+
+  MPI_Barrier(MPI_COMM_WORLD);
+
+  remove(prev);
+}
+
+ChkptDelta::Latest
+ChkptDelta::latest(const std::string& basefile, double tb)
+{
+  // Parse the manifest on the root node
+  //
+  Latest delta;
+  int found = 0;
+
+  if (myid==0) {
+    std::ifstream in(manifestName(basefile));
+    if (in) {
+      double tm = 0.0;
+      bool gotbase = false;
+      std::string line;
+      while (std::getline(in, line)) {
+	std::istringstream sin(line);
+	std::string tag;
+	sin >> tag;
+	if (tag == "base" ) gotbase = static_cast<bool>(sin >> tm);
+	if (tag == "delta")
+	  found = static_cast<bool>(sin >> delta.seq >> delta.time >> delta.nprocs);
+      }
+
+      // The base image must be the one the deltas were written against
+      //
+      if (found and (not gotbase or
+		     fabs(tm - tb) > 1.0e-12*std::max<double>(1.0, fabs(tb)))) {
+	std::cout << "ChkptDelta: manifest <" << manifestName(basefile)
+		  << "> base time " << tm << " does not match T=" << tb
+		  << ", ignoring deltas" << std::endl;
+	found = 0;
+      }
+
+      if (found and delta.nprocs < 1) found = 0;
+    }
+  }
+
+  MPI_Bcast(&found, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  if (not found) return Latest();
+
+  MPI_Bcast(&delta.seq,    1, MPI_INT,    0, MPI_COMM_WORLD);
+  MPI_Bcast(&delta.nprocs, 1, MPI_INT,    0, MPI_COMM_WORLD);
+  MPI_Bcast(&delta.time,   1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+  return delta;
+}
+
+// Exchange variable-length blocks of T between all processes.  On
+// return, rcount holds the number of elements received from each
+// process.
+//
+template<typename T>
+static std::vector<T> routeBlocks(const std::vector<std::vector<T>>& send,
+			       std::vector<int>& rcount)
+{
+  std::vector<int> scount(numprocs), sdispl(numprocs), rdispl(numprocs);
+  std::vector<int> rbytes(numprocs);
+
+  size_t stotal = 0;
+  for (int n=0; n<numprocs; n++) {
+    scount[n] = send[n].size()*sizeof(T);
+    sdispl[n] = stotal;
+    stotal   += scount[n];
+  }
+
+  MPI_Alltoall(scount.data(), 1, MPI_INT, rbytes.data(), 1, MPI_INT,
+	       MPI_COMM_WORLD);
+
+  size_t rtotal = 0;
+  rcount.resize(numprocs);
+  for (int n=0; n<numprocs; n++) {
+    rdispl[n] = rtotal;
+    rtotal   += rbytes[n];
+    rcount[n] = rbytes[n]/sizeof(T);
+  }
+
+  std::vector<T> sbuf, rbuf(rtotal/sizeof(T));
+  sbuf.reserve(stotal/sizeof(T));
+  for (auto & v : send) sbuf.insert(sbuf.end(), v.begin(), v.end());
+
+  MPI_Alltoallv(sbuf.data(), scount.data(), sdispl.data(), MPI_BYTE,
+		rbuf.data(), rbytes.data(), rdispl.data(), MPI_BYTE,
+		MPI_COMM_WORLD);
+
+  return rbuf;
+}
+
+void ChkptDelta::replay(const std::string& basefile, const Latest& delta,
+			ComponentContainer* comp)
+{
+  if (delta.seq < 0) return;
+
+  const int n = delta.seq, nprocs = delta.nprocs;
+
+  if (myid==0)
+    std::cout << "---- ChkptDelta: replaying delta " << n << " at T="
+	      << delta.time << " from " << nprocs << " files" << std::endl;
+
+  // Each process reads the delta files r = myid, myid + numprocs,
+  // ...  so the files are read once whether or not the process count
+  // has changed since they were written.  The root always reads file
+  // 0, which holds the frame state.
+  //
+  struct Reader
+  {
+    std::string file;
+    std::ifstream in;
+    unsigned long count;
+  };
+
+  std::vector<Reader> readers;
+
+  for (int r=myid; r<nprocs; r+=numprocs) {
+    readers.emplace_back();
+    Reader & rd = readers.back();
+    rd.file = deltaName(basefile, n, r);
+    rd.in.open(rd.file, std::ios::binary);
+    if (not rd.in) throw FileOpenError(rd.file, __FILE__, __LINE__, 1051, true);
+
+    unsigned long mgc;
+    double time;
+    int ncomp;
+
+    rd.in.read((char*)&mgc,   sizeof(unsigned long));
+    rd.in.read((char*)&time,  sizeof(double));
+    rd.in.read((char*)&ncomp, sizeof(int));
+
+    if (rd.in.fail() or mgc != magic or ncomp != comp->ncomp or
+	fabs(time - delta.time) > 1.0e-12*std::max<double>(1.0, fabs(time))) {
+      std::ostringstream sout;
+      sout << "ChkptDelta::replay: bad header in <" << rd.file << ">";
+      throw GenericError(sout.str(), __FILE__, __LINE__, 1052, true);
+    }
+  }
+
+  // Records are exchanged in rounds of at most this many per reader
+  // to bound the buffer sizes
+  //
+  const unsigned long chunk = 1<<20;
+
+  std::vector<double> frame;
+  std::vector<int> rcount;
+
+  for (auto c : comp->components) {
+
+    const int ni = c->niattrib, nd = c->ndattrib;
+
+    const size_t fixed = sizeof(unsigned long) + sizeof(unsigned) +
+      sizeof(unsigned char) + 6*sizeof(double);
+    const size_t extra = sizeof(double) + ni*sizeof(int) + nd*sizeof(double);
+
+    unsigned long nrec = 0;
+
+    for (auto & rd : readers) {
+      int fi, fd, nf;
+
+      rd.in.read((char*)&rd.count, sizeof(unsigned long));
+      rd.in.read((char*)&fi,       sizeof(int));
+      rd.in.read((char*)&fd,       sizeof(int));
+      rd.in.read((char*)&nf,       sizeof(int));
+
+      if (rd.in.fail() or fi != ni or fd != nd) {
+	std::ostringstream sout;
+	sout << "ChkptDelta::replay: attribute mismatch for component <"
+	     << c->name << "> in <" << rd.file << ">";
+	throw GenericError(sout.str(), __FILE__, __LINE__, 1052, true);
+      }
+
+      if (nf > 0) {
+	frame.resize(nf);
+	rd.in.read((char*)frame.data(), nf*sizeof(double));
+      }
+
+      nrec += rd.count;
+    }
+
+    // Restore the frame state from the root's file
+    //
+    int nf = frame.size();
+    MPI_Bcast(&nf, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (nf) {
+      frame.resize(nf);
+      MPI_Bcast(frame.data(), nf, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+      unpackFrame(c, frame);
+    }
+    frame.clear();
+
+    // Register the particles owned by each process with a directory
+    // process, indx % numprocs
+    //
+    auto & particles = c->Particles();
+
+    std::vector<std::vector<unsigned long>> sendI(numprocs);
+    for (auto & p : particles) sendI[p.first % numprocs].push_back(p.first);
+
+    std::unordered_map<unsigned long, int> owner;
+    {
+      auto recv = routeBlocks(sendI, rcount);
+      owner.reserve(recv.size());
+      size_t k = 0;
+      for (int r=0; r<numprocs; r++)
+	for (int j=0; j<rcount[r]; j++) owner[recv[k++]] = r;
+    }
+    for (auto & v : sendI) std::vector<unsigned long>().swap(v);
+
+    unsigned long rounds = (nrec + chunk - 1)/chunk;
+    MPI_Allreduce(MPI_IN_PLACE, &rounds, 1, MPI_UNSIGNED_LONG, MPI_MAX,
+		  MPI_COMM_WORLD);
+
+    std::vector<char> recs;
+    std::vector<size_t> offset;
+    std::vector<std::vector<int>>  reply(numprocs);
+    std::vector<std::vector<char>> sendR(numprocs);
+    auto rd = readers.begin();
+
+    for (unsigned long round=0; round<rounds; round++) {
+
+      // Read the next block of records
+      //
+      recs.clear();
+      offset.clear();
+
+      while (offset.size() < chunk and rd != readers.end()) {
+	if (rd->count == 0) { rd++; continue; }
+
+	size_t pos = recs.size();
+	recs.resize(pos + fixed + extra);
+	char* b = &recs[pos];
+	rd->in.read(b, fixed);
+
+	unsigned char flag;
+	memcpy(&flag, b + sizeof(unsigned long) + sizeof(unsigned),
+	       sizeof(unsigned char));
+
+	if (flag) rd->in.read(b + fixed, extra);
+	else      recs.resize(pos + fixed);
+
+	if (rd->in.fail()) {
+	  std::ostringstream sout;
+	  sout << "ChkptDelta::replay: short read in <" << rd->file << ">";
+	  throw GenericError(sout.str(), __FILE__, __LINE__, 1052, true);
+	}
+
+	offset.push_back(pos);
+	rd->count--;
+      }
+
+      // Look up the owners of the records from the directory
+      //
+      for (auto & v : sendI) v.clear();
+      for (auto pos : offset) {
+	unsigned long indx;
+	memcpy(&indx, &recs[pos], sizeof(unsigned long));
+	sendI[indx % numprocs].push_back(indx);
+      }
+
+      {
+	auto query = routeBlocks(sendI, rcount);
+	size_t k = 0;
+	for (int r=0; r<numprocs; r++) {
+	  reply[r].resize(rcount[r]);
+	  for (int j=0; j<rcount[r]; j++) {
+	    auto it = owner.find(query[k++]);
+	    reply[r][j] = it == owner.end() ? -1 : it->second;
+	  }
+	}
+      }
+
+      std::vector<int> answer = routeBlocks(reply, rcount);
+
+      // Send the records to their owners.  Replies from each
+      // directory process arrive in query order.
+      //
+      std::vector<size_t> next(numprocs, 0);
+      for (int r=1; r<numprocs; r++) next[r] = next[r-1] + rcount[r-1];
+
+      for (auto & v : sendR) v.clear();
+      for (auto pos : offset) {
+	unsigned long indx;
+	unsigned char flag;
+	memcpy(&indx, &recs[pos], sizeof(unsigned long));
+	memcpy(&flag, &recs[pos] + sizeof(unsigned long) + sizeof(unsigned),
+	       sizeof(unsigned char));
+
+	int own = answer[next[indx % numprocs]++];
+	if (own < 0) continue;
+
+	const char* b = &recs[pos];
+	sendR[own].insert(sendR[own].end(), b, b + fixed + (flag ? extra : 0));
+      }
+
+      // Apply the records received
+      //
+      auto mine = routeBlocks(sendR, rcount);
+
+      const char* b = mine.data(), *end = b + mine.size();
+      while (b < end) {
+	unsigned long indx;
+	unsigned char flag;
+	memcpy(&indx, b, sizeof(unsigned long));
+	memcpy(&flag, b + sizeof(unsigned long) + sizeof(unsigned),
+	       sizeof(unsigned char));
+
+	Particle* p = particles[indx].get();
+	b += sizeof(unsigned long);
+	memcpy(&p->level, b, sizeof(unsigned)); b += sizeof(unsigned) + sizeof(unsigned char);
+	p->level = std::min<unsigned>(p->level, multistep);
+	memcpy(p->pos, b, 3*sizeof(double));    b += 3*sizeof(double);
+	memcpy(p->vel, b, 3*sizeof(double));    b += 3*sizeof(double);
+
+	if (flag) {
+	  memcpy(&p->mass, b, sizeof(double)); b += sizeof(double);
+	  if (ni) memcpy(p->iattrib.data(), b, ni*sizeof(int));
+	  b += ni*sizeof(int);
+	  if (nd) memcpy(p->dattrib.data(), b, nd*sizeof(double));
+	  b += nd*sizeof(double);
+	}
+      }
+    }
+  }
+
+  for (auto c : comp->components) c->reset_level_lists();
+}
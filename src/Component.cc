@@ -6,6 +6,12 @@
 #include <string>
 #include <memory>
 #include <map>
+#include <cmath>
+#include <numeric>
+#include <limits>
+#include <new>
+#include <unordered_set>
+#include <set>
 
 #include <Component.H>
 #include <Bessel.H>
@@ -22,6 +28,7 @@
 #include <YamlCheck.H>
 
 #include "expand.H"
+#include <ThreadPool.H>
 
 // For sort algorithm below
 bool less_loadb(const loadb_datum& one, const loadb_datum& two)
@@ -84,7 +91,10 @@ const std::set<std::string> Component::valid_keys_parm =
     "ctr_name",
     "noswitch",
     "freezeL",
-    "dtreset"
+    "dtreset",
+    "soa",
+    "reorder",
+    "sfc"
   };
 
 const std::set<std::string> Component::valid_keys_force =
@@ -246,6 +256,9 @@ Component::Component(YAML::Node& CONF)
   buffered    = true;		// Use buffered writes for POSIX binary
   noswitch    = false;		// Allow multistep switching at master step only
   dtreset     = true;		// Select time step from criteria over last step
+  use_soa     = false;		// Use the PartMap directly in force methods
+  reorder     = pinthreads and nthrds>1; // First-touch for pinned threads
+  sfc         = "none";		// No space-filling-curve ordering
   freezeLev   = false;		// Only compute new levels on first step
 
   set_default_values();
@@ -275,6 +288,8 @@ Component::Component(YAML::Node& CONF)
 
   reset_level_lists();
 
+  sfc_order(false);
+
   modified = 0;
 }
 
@@ -358,6 +373,9 @@ void Component::set_default_values()
   if (!cconf["noswitch"])        cconf["noswitch"]    = noswitch;
   if (!cconf["freezeL"])         cconf["freezeL"]     = freezeLev;
   if (!cconf["dtreset"])         cconf["dtreset"]     = dtreset;
+  if (!cconf["soa"])             cconf["soa"]         = use_soa;
+  if (!cconf["reorder"])         cconf["reorder"]     = reorder;
+  if (!cconf["sfc"])             cconf["sfc"]         = sfc;
 }
 
 
@@ -370,7 +388,6 @@ public:
 };
 
 static vector<thrd_pass_reset> td;
-static pthread_t* t  = 0;
 
 void * reset_level_lists_thrd(void *ptr)
 {
@@ -398,75 +415,40 @@ void * reset_level_lists_thrd(void *ptr)
   return (NULL);
 }
 
-void Component::reset_level_lists()
+void Component::reset_level_lists(unsigned first)
 {
-  if (td.size()==0) {
-    td = vector<thrd_pass_reset>(nthrds);
+  // Only the particles on levels [first, multistep] can have changed
+  // level since the last reset, so there is no need to visit the
+  // entire particle map
+  //
+  if (first>0 and levlist.size()==multistep+1) {
 
-    t  = new pthread_t [nthrds];
+    std::vector< std::vector<int> > newlist(multistep+1);
 
-    if (!t) {
-      std::ostringstream sout;
-      sout << "Process " << myid
-	   << ": reset_level_lists: error allocating memory for thread";
-      throw GenericError(sout.str(), __FILE__, __LINE__, 1006, true);
+    for (unsigned lev=first; lev<=multistep; lev++) {
+      for (auto indx : levlist[lev]) {
+	unsigned nlev = Part(indx)->level;
+	if (nlev<first) levlist[nlev].push_back(indx);
+	else            newlist[nlev].push_back(indx);
+      }
     }
-  }
-  
-  if (nthrds==1) {
 
-    td[0].id = 0;
-    td[0].c  = this;
-    td[0].newlist  = std::vector< std::vector<int> >(multistep+1);
+    for (unsigned lev=first; lev<=multistep; lev++)
+      levlist[lev].swap(newlist[lev]);
 
-    reset_level_lists_thrd(&td[0]);
-
-  } else {
+    return;
+  }
 
-    //
-    // Make the <nthrds> threads
-    //
-    int errcode;
-    void *retval;
-  
-    for (int i=0; i<nthrds; i++) {
-    
-      td[i].id = i;
-      td[i].c  = this;
-      td[i].newlist  = std::vector< std::vector<int> >(multistep+1);
-      
-      errcode =  pthread_create(&t[i], 0, reset_level_lists_thrd, &td[i]);
+  if (td.size()==0) td = vector<thrd_pass_reset>(nthrds);
 
-      if (errcode) {
-	std::ostringstream sout;
-	sout << "Process " << myid
-	     << " reset_level_lists: cannot make thread " << i
-	     << ", errcode=" << errcode;;
-	throw GenericError(sout.str(), __FILE__, __LINE__, 1007, true);
-      }
-#ifdef DEBUG
-      else {
-	cout << "Process " << myid << ": thread <" << i << "> created\n";
-      }
-#endif
-    }
-    
-    //
-    // Collapse the threads
-    //
-    for (int i=0; i<nthrds; i++) {
-      if ((errcode=pthread_join(t[i], &retval))) {
-	std::ostringstream sout;
-	sout << "Process " << myid
-	     << " reset_level_lists: thread join " << i
-	     << " failed, errcode=" << errcode;
-	throw GenericError(sout.str(), __FILE__, __LINE__, 1008, true);
-      }
-#ifdef DEBUG    
-      cout << "Process " << myid << ": multistep thread <" << i << "> thread exited\n";
-#endif
-    }
+  for (int i=0; i<nthrds; i++) {
+    td[i].id = i;
+    td[i].c  = this;
+    td[i].newlist  = std::vector< std::vector<int> >(multistep+1);
   }
+
+  ThreadPool::get().run([](int i) { reset_level_lists_thrd(&td[i]); });
+
 				// Particle list per level.
 				// Begin with empty lists . . .
   levlist = std::vector< std::vector<int> > (multistep+1);
@@ -478,6 +460,14 @@ void Component::reset_level_lists()
     }
   }
   
+  // Order each level along the space-filling curve
+  //
+  if (sfc_type != SFC::none) sort_levels_by_key();
+
+  // Make each level a contiguous block in memory
+  //
+  if (reorder) reorder_particles();
+
   if (VERBOSE>10 and particles.size()) {
 				// Level creation check
     for (int n=0; n<numprocs; n++) {
@@ -524,6 +514,364 @@ void Component::reset_level_lists()
 
 }
 
+// Storage for a block of particles that are copy constructed in place
+// by the pool threads, so that each page is first written by the
+// thread that processes its particles
+//
+class ParticleBlock
+{
+private:
+  Particle* data;
+  std::vector<char> made;
+
+public:
+  ParticleBlock(size_t n) : made(n, 0)
+  {
+    data = static_cast<Particle*>(::operator new(n*sizeof(Particle)));
+  }
+
+  ~ParticleBlock()
+  {
+    for (size_t k=0; k<made.size(); k++) if (made[k]) data[k].~Particle();
+    ::operator delete(data);
+  }
+
+  Particle* make(size_t k, const Particle& p)
+  {
+    new (&data[k]) Particle(p);
+    made[k] = 1;
+    return &data[k];
+  }
+};
+
+void Component::reorder_particles()
+{
+  // Copy the particles into a single block in level-list order.  The
+  // map entries share ownership of the block so the previous
+  // allocations are released as the map entries are replaced.
+  //
+  // Each level is copied using the static partition of the threaded
+  // force passes so that, with pinned threads, a thread's particles
+  // are placed on its own NUMA node.
+  //
+  std::vector<size_t> off(levlist.size()+1, 0);
+  for (size_t l=0; l<levlist.size(); l++)
+    off[l+1] = off[l] + levlist[l].size();
+
+  auto block = std::make_shared<ParticleBlock>(off.back());
+
+  // The previous blocks are released below, so this is the only one
+  //
+  blocks.assign(1, {std::weak_ptr<void>(block), off.back()});
+
+  ThreadPool::get().run(nthrds, [&](int id) {
+    for (size_t l=0; l<levlist.size(); l++) {
+      size_t n = levlist[l].size();
+      size_t nbeg = n*id/nthrds, nend = n*(id+1)/nthrds;
+      for (size_t q=nbeg; q<nend; q++) {
+	// Map entries are only found and replaced here, never
+	// inserted, so the threads may share the map
+	auto it = particles.find(levlist[l][q]);
+	Particle* p = block->make(off[l] + q, *it->second);
+	it->second = PartPtr(block, p);
+      }
+    }
+  });
+}
+
+// Space-filling-curve keys from integer coordinates on a 2^bits grid
+// per dimension.  The Hilbert key uses Skilling's transpose algorithm
+// (AIP Conf. Proc. 707, 381, 2004) followed by the same bit
+// interleaving as the Morton key.
+//
+static unsigned long sfc_interleave(const unsigned X[3], int bits)
+{
+  unsigned long key = 0;
+  for (int b=bits-1; b>=0; b--) {
+    for (int k=0; k<3; k++) key = (key << 1) | ((X[k] >> b) & 1u);
+  }
+  return key;
+}
+
+static unsigned long sfc_hilbert(unsigned X[3], int bits)
+{
+  const unsigned M = 1u << (bits-1);
+  unsigned P, Q, t;
+
+  // Inverse undo
+  for (Q=M; Q>1; Q>>=1) {
+    P = Q - 1;
+    for (int k=0; k<3; k++) {
+      if (X[k] & Q) X[0] ^= P;
+      else {
+	t = (X[0] ^ X[k]) & P;
+	X[0] ^= t;
+	X[k] ^= t;
+      }
+    }
+  }
+
+  // Gray encode
+  for (int k=1; k<3; k++) X[k] ^= X[k-1];
+  t = 0;
+  for (Q=M; Q>1; Q>>=1) if (X[2] & Q) t ^= Q - 1;
+  for (int k=0; k<3; k++) X[k] ^= t;
+
+  return sfc_interleave(X, bits);
+}
+
+unsigned long Component::sfc_key(const double* pos)
+{
+  const unsigned top = (1u << sfcBits) - 1;
+  unsigned X[3];
+
+  for (int k=0; k<3; k++) {
+    double x = (pos[k] - sfc_lo[k])*sfc_scl[k];
+    if (x < 0.0 or std::isnan(x)) x = 0.0;
+    X[k] = x < top ? static_cast<unsigned>(x) : top;
+  }
+
+  if (sfc_type == SFC::hilbert) return sfc_hilbert(X, sfcBits);
+  return sfc_interleave(X, sfcBits);
+}
+
+void Component::sort_levels_by_key()
+{
+  // Keys are refreshed from the current positions on the grid of the
+  // last distribution so the order follows the particles between
+  // redistributions; particles outside the grid are clamped to its
+  // boundary
+  //
+  if (not sfc_box) return;
+
+  for (auto & v : levlist) {
+    int num = v.size();
+    std::vector<std::pair<unsigned long, int>> kv(num);
+
+#pragma omp parallel for
+    for (int q=0; q<num; q++) {
+      Particle *p = Part(v[q]);
+      p->key = sfc_key(p->pos);
+      kv[q] = {p->key, v[q]};
+    }
+
+    std::sort(kv.begin(), kv.end());
+
+    for (int q=0; q<num; q++) v[q] = kv[q].second;
+  }
+}
+
+void Component::sfc_order(bool weighted)
+{
+  if (sfc_type == SFC::none) return;
+
+  // Global bounding box
+  //
+  double lo[3], hi[3];
+  for (int k=0; k<3; k++) {
+    lo[k] =  std::numeric_limits<double>::max();
+    hi[k] = -std::numeric_limits<double>::max();
+  }
+
+  for (auto & p : particles) {
+    for (int k=0; k<3; k++) {
+      lo[k] = std::min<double>(lo[k], p.second->pos[k]);
+      hi[k] = std::max<double>(hi[k], p.second->pos[k]);
+    }
+  }
+
+  MPI_Allreduce(MPI_IN_PLACE, lo, 3, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+  MPI_Allreduce(MPI_IN_PLACE, hi, 3, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+
+  const double top = static_cast<double>((1u << sfcBits) - 1);
+  for (int k=0; k<3; k++) {
+    sfc_lo[k]  = lo[k];
+    sfc_scl[k] = hi[k] > lo[k] ? top/(hi[k] - lo[k]) : 0.0;
+  }
+  sfc_box = true;
+
+  // Keys and weights in key order.  The weight is the predicted work
+  // from the cost model or unity for equal particle counts.
+  //
+  std::vector<std::pair<unsigned long, double>> kw;
+  kw.reserve(particles.size());
+
+  for (auto & p : particles) {
+    p.second->key = sfc_key(p.second->pos);
+    kw.push_back({p.second->key, weighted ? p.second->effort : 1.0});
+  }
+
+  std::sort(kw.begin(), kw.end());
+
+  if (numprocs>1) {
+
+    // Regular samples of the local key distribution.  Each sample is
+    // the last key of its run and carries the weight of the run.
+    //
+    const size_t nsamp = std::min<size_t>(kw.size(), sfcSamples);
+    std::vector<unsigned long> skey(nsamp);
+    std::vector<double> swgt(nsamp, 0.0);
+
+    for (size_t s=0; s<nsamp; s++) {
+      size_t beg = s*kw.size()/nsamp, end = (s+1)*kw.size()/nsamp;
+      for (size_t i=beg; i<end; i++) swgt[s] += kw[i].second;
+      skey[s] = kw[end-1].first;
+    }
+
+    // Gather the samples on the root node
+    //
+    int mysamp = nsamp;
+    std::vector<int> cnts(numprocs), disp(numprocs, 0);
+    MPI_Gather(&mysamp, 1, MPI_INT, cnts.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+    int tsamp = 0;
+    if (myid==0) {
+      for (int n=0; n<numprocs; n++) {
+	disp[n] = tsamp;
+	tsamp += cnts[n];
+      }
+    }
+
+    std::vector<unsigned long> akey(tsamp);
+    std::vector<double> awgt(tsamp);
+
+    MPI_Gatherv(skey.data(), mysamp, MPI_UNSIGNED_LONG,
+		akey.data(), cnts.data(), disp.data(), MPI_UNSIGNED_LONG,
+		0, MPI_COMM_WORLD);
+
+    MPI_Gatherv(swgt.data(), mysamp, MPI_DOUBLE,
+		awgt.data(), cnts.data(), disp.data(), MPI_DOUBLE,
+		0, MPI_COMM_WORLD);
+
+    // Splitters at the cumulative rate targets.  Process n receives
+    // the keys in [splitter[n-1], splitter[n]) (see the upper_bound
+    // below); the first and last processes are open below and above.
+    //
+    std::vector<unsigned long> splitter(numprocs-1, 0);
+
+    if (myid==0) {
+      std::vector<int> order(tsamp);
+      for (int i=0; i<tsamp; i++) order[i] = i;
+      std::sort(order.begin(), order.end(),
+		[&akey](int a, int b) { return akey[a] < akey[b]; });
+
+      double wtot = 0.0;
+      for (auto w : awgt) wtot += w;
+
+      double cum = 0.0, target = 0.0;
+      int i = 0;
+      for (int n=0; n<numprocs-1; n++) {
+	target += comp->rates[n]*wtot;
+	while (i<tsamp and cum + awgt[order[i]] <= target) cum += awgt[order[i++]];
+	if (i<tsamp)    splitter[n] = akey[order[i]];
+	else if (tsamp) splitter[n] = akey[order[tsamp-1]];
+	if (n>0) splitter[n] = std::max<unsigned long>(splitter[n], splitter[n-1]);
+      }
+    }
+
+    MPI_Bcast(splitter.data(), numprocs-1, MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
+
+    // Ship each particle to the owner of its key range
+    //
+    std::vector<std::vector<PartPtr>> out(numprocs);
+    for (auto & p : particles) {
+      int n = std::upper_bound(splitter.begin(), splitter.end(), p.second->key)
+	- splitter.begin();
+      if (n != myid) out[n].push_back(p.second);
+    }
+
+    bulk_exchange(out);
+  }
+
+  update_indices();
+
+  // Rebuild the level lists in key order
+  //
+  reset_level_lists();
+}
+
+void Component::ParticlesToSoA(unsigned mlevel)
+{
+  soa.valid = false;
+
+  // Particles are on the device in this case
+  //
+  if (not use_soa or use_cuda) return;
+
+  // Assign slot ranges level by level
+  //
+  soa.minlev = mlevel;
+  soa.levoff.assign(multistep+2, 0);
+
+  unsigned nslot = 0;
+  for (unsigned lev=0; lev<=multistep; lev++) {
+    soa.levoff[lev] = nslot;
+    if (lev>=mlevel) nslot += levlist[lev].size();
+  }
+  soa.levoff[multistep+1] = nslot;
+
+  soa.resize(nslot);
+
+  // One map lookup per particle; the force methods use the slots.
+  // Each level is packed with the static partition of the threaded
+  // force passes.
+  //
+  std::vector<unsigned> miss(nthrds, 0);
+
+  ThreadPool::get().run(nthrds, [&](int id) {
+    for (unsigned lev=mlevel; lev<=multistep; lev++) {
+      unsigned beg = soa.levoff[lev];
+      size_t n = levlist[lev].size();
+      size_t nbeg = n*id/nthrds, nend = n*(id+1)/nthrds;
+      for (size_t q=nbeg; q<nend; q++) {
+	auto it = particles.find(levlist[lev][q]);
+	if (it == particles.end()) { miss[id]++; continue; }
+
+	Particle *p = it->second.get();
+	unsigned s = beg + q;
+
+	soa.part[s] = p;
+	soa.indx[s] = p->indx;
+	soa.mass[s] = p->mass;
+	for (int k=0; k<3; k++) {
+	  soa.pos(s, k) = p->pos[k];
+	  soa.vel(s, k) = p->vel[k];
+	}
+      }
+    }
+  });
+
+  unsigned bad = std::accumulate(miss.begin(), miss.end(), 0u);
+
+  if (bad) {
+    std::ostringstream sout;
+    sout << "Component <" << name << ">: ParticlesToSoA found " << bad
+	 << " level list entries with no particle";
+    throw GenericError(sout.str(), __FILE__, __LINE__, 1008, true);
+  }
+
+  soa.valid = true;
+}
+
+void Component::SoAToParticles()
+{
+  if (not soa.valid) return;
+
+  size_t nslot = soa.size();
+
+  ThreadPool::get().run(nthrds, [&](int id) {
+    size_t nbeg = nslot*id/nthrds, nend = nslot*(id+1)/nthrds;
+    for (size_t s=nbeg; s<nend; s++) {
+      Particle *p = soa.part[s];
+      for (int k=0; k<3; k++) p->acc[k] += soa.acc(s, k);
+      p->pot    += soa.pot[s];
+      p->potext += soa.potext[s];
+    }
+  });
+
+  soa.valid = false;
+}
+
 void Component::print_level_lists(double T)
 {
 				// Print out level info
@@ -746,6 +1094,9 @@ Component::Component(YAML::Node& CONF, istream *in, bool SPL) : conf(CONF)
   buffered    = true;		// Use buffered writes for POSIX binary
   noswitch    = false;		// Allow multistep switching at master step only
   dtreset     = true;		// Select level from criteria over last step
+  use_soa     = false;		// Use the PartMap directly in force methods
+  reorder     = pinthreads and nthrds>1; // First-touch for pinned threads
+  sfc         = "none";		// No space-filling-curve ordering
   freezeLev   = false;		// Only compute new levels on first step
 
   configure();
@@ -768,6 +1119,8 @@ Component::Component(YAML::Node& CONF, istream *in, bool SPL) : conf(CONF)
 
   reset_level_lists();
 
+  sfc_order(false);
+
   pbuf.resize(PFbufsz);
 }
 
@@ -824,6 +1177,9 @@ void Component::configure(void)
     if (cconf["noswitch"])   noswitch  = cconf["noswitch"].as<bool>();
     if (cconf["freezeL"])   freezeLev  = cconf["freezeL" ].as<bool>();
     if (cconf["dtreset"])     dtreset  = cconf["dtreset" ].as<bool>();
+    if (cconf["soa"    ])     use_soa  = cconf["soa"     ].as<bool>();
+    if (cconf["reorder"])     reorder  = cconf["reorder" ].as<bool>();
+    if (cconf["sfc"    ])     sfc      = cconf["sfc"     ].as<std::string>();
     
     if (cconf["ton"]) {
       ton = cconf["ton"].as<double>();
@@ -859,6 +1215,17 @@ void Component::configure(void)
     throw std::runtime_error("Component: error parsing YAML");
   }
 
+  // Space-filling-curve ordering
+  //
+  if      (sfc == "none"   ) sfc_type = SFC::none;
+  else if (sfc == "morton" ) sfc_type = SFC::morton;
+  else if (sfc == "hilbert") sfc_type = SFC::hilbert;
+  else {
+    std::string msg("Component: unknown sfc type <" + sfc + ">, "
+		    "expected one of none, morton, hilbert");
+    throw GenericError(msg, __FILE__, __LINE__, 1013, false);
+  }
+
 
   // Instantiate the force ("reflection" by hand)
   //
@@ -1284,7 +1651,7 @@ void Component::read_bodies_and_distribute_ascii(void)
   }
 				// Broadcast attributes for this
 				// phase-space component
-  MPI_Bcast(&nbodies_tot, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&nbodies_tot, 1, MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
   MPI_Bcast(&niattrib,    1, MPI_INT, 0, MPI_COMM_WORLD);
   MPI_Bcast(&ndattrib,    1, MPI_INT, 0, MPI_COMM_WORLD);
 
@@ -1319,7 +1686,7 @@ void Component::read_bodies_and_distribute_ascii(void)
 
     nbodies = nbodies_table[0];
 
-    unsigned icount, ibufcount;
+    unsigned long icount, ibufcount;
     for (int n=1; n<numprocs; n++) {
 
       pf->ShipParticles(n, 0, nbodies_table[n]);
@@ -1330,7 +1697,7 @@ void Component::read_bodies_and_distribute_ascii(void)
 
 	PartPtr part = std::make_shared<Particle>(niattrib, ndattrib);
 
-	int i = nbodies_index[n-1] + 1 + icount;
+	unsigned long i = nbodies_index[n-1] + 1 + icount;
 	part->readAscii(aindex, i, &fin);
 
 	r2 = 0.0;
@@ -1461,7 +1828,7 @@ void Component::read_bodies_and_distribute_binary_out(istream *in)
 
 				// Broadcast attributes for this
 				// phase-space component
-  MPI_Bcast(&nbodies_tot, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&nbodies_tot, 1, MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
   MPI_Bcast(&niattrib,    1, MPI_INT, 0, MPI_COMM_WORLD);
   MPI_Bcast(&ndattrib,    1, MPI_INT, 0, MPI_COMM_WORLD);
   MPI_Bcast(&ninfochar,   1, MPI_INT, 0, MPI_COMM_WORLD);
@@ -1558,93 +1925,72 @@ void Component::read_bodies_and_distribute_binary_out(istream *in)
     }
   } // END: parse and assign parameter info from PSP
   
-  double rmax1=0.0, r2;
+  double r2max = 0.0;
 
   is_init = 1;
   setup_distribution();
   is_init = 0;
-				// Initialize the particle ferry
-				// instance with dynamic attribute
-				// sizes
-  if (not pf) pf = ParticleFerryPtr(new ParticleFerry(niattrib, ndattrib));
-
-				// Form cumulative and differential
-				// bodies list
-  unsigned int ipart=0;
 
-  if (myid==0) {
-				// Read root node particles
-    seq_cur = 0;
-
-    rmax1 = 0.0;
-    for (unsigned i=1; i<=nbodies_table[0]; i++)
-    {
-      PartPtr part = std::make_shared<Particle>(niattrib, ndattrib);
-      
-      part->readBinary(rsize, indexing, ++seq_cur, in);
-
-      r2 = 0.0;
-      for (int j=0; j<3; j++) r2 += part->pos[j]*part->pos[j];
-      rmax1 = max<double>(r2, rmax1);
-
-				// Load the particle
-      particles[part->indx] = part;
-
-				// Record top_seq
-      top_seq = std::max<unsigned long>(part->indx, top_seq);
-    }
-
-    nbodies = nbodies_table[0];
-
-
-				// Now load the other nodes
-    unsigned icount;
-    for (int n=1; n<numprocs; n++) {
-
-      cout << "---- Component [" << name << "]: loading node <" << n << ">\n";
+  // Every process reads its own slice of the particle records: the
+  // records have a fixed size so the slice is a contiguous byte range
+  // that starts at the current position of the root's stream
+  //
+  MPI_Offset start = 0;
+  if (myid==0) start = in->tellg();
+  MPI_Bcast(&start, 1, MPI_OFFSET, 0, MPI_COMM_WORLD);
 
-      pf->ShipParticles(n, 0, nbodies_table[n]);
+  size_t recsz = pspRecordSize();
+  unsigned long first = myid ? nbodies_index[myid-1] : 0;
+  nbodies = nbodies_table[myid];
 
-      icount = 0;
-      while (icount < nbodies_table[n]) {
-	PartPtr part = std::make_shared<Particle>(niattrib, ndattrib);
+  std::string resfile = outdir + infile;
 
-	part->readBinary(rsize, indexing, ++seq_cur, in);
+  MPI_File fh;
+  int ret = MPI_File_open(MPI_COMM_WORLD, resfile.c_str(), MPI_MODE_RDONLY,
+			  MPI_INFO_NULL, &fh);
 
-	r2 = 0.0;
-	for (int k=0; k<3; k++) 
-	  r2 += part->pos[k]*part->pos[k];
+  if (ret != MPI_SUCCESS) {
+    std::ostringstream sout;
+    sout << "Component::read_bodies_and_distribute_binary_out: "
+	 << "could not open <" << resfile << "> for MPI-IO";
+    throw GenericError(sout.str(), __FILE__, __LINE__, 1010, true);
+  }
 
-	rmax1 = max<double>(r2, rmax1);
+  // Read in chunks of at most 1 GB so that the byte counts fit in an
+  // int.  The reads are collective so every process makes the same
+  // number of calls.
+  //
+  unsigned long chunk = std::max<unsigned long>(1, (1ul<<30)/recsz);
+  unsigned long nmine = nbodies, nmost;
+  MPI_Allreduce(&nmine, &nmost, 1, MPI_UNSIGNED_LONG, MPI_MAX, MPI_COMM_WORLD);
 
-	icount++;
-	pf->SendParticle(part);
+  std::vector<char> buf(std::min<unsigned long>(chunk, nmine)*recsz);
 
-				// Record top_seq
-	top_seq = std::max<unsigned long>(part->indx, top_seq);
-      }
+  seq_cur = first;
+  top_seq = 0;
 
-    }
+  for (unsigned long beg=0; beg<nmost; beg+=chunk) {
+    unsigned long cnt = beg<nmine ? std::min<unsigned long>(chunk, nmine-beg) : 0;
 
-  } else {
+    MPI_File_read_at_all(fh, start + (first + beg)*recsz, buf.data(),
+			 cnt*recsz, MPI_CHAR, MPI_STATUS_IGNORE);
 
-    pf->ShipParticles(myid, 0, nbodies);
-      
-    int icount = 0;
-    PartPtr part;
-    while ((part=pf->RecvParticle())) {
-      particles[part->indx] = part;
-      icount++;
-    }
+    unpack_records(buf.data(), cnt, r2max);
   }
 
+  MPI_File_close(&fh);
+
+				// Position the root's stream at the
+				// next component
+  if (myid==0) in->seekg(start + static_cast<MPI_Offset>(nbodies_tot)*recsz);
 
 				// Default: set to max radius
-  rmax = sqrt(fabs(rmax1));
-  MPI_Bcast(&rmax, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+  MPI_Allreduce(MPI_IN_PLACE, &r2max, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+  rmax = sqrt(fabs(r2max));
 
-				// Send top_seq to all nodes
-  MPI_Bcast(&top_seq, 1, MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
+				// Share top_seq with all nodes
+  MPI_Allreduce(MPI_IN_PLACE, &top_seq, 1, MPI_UNSIGNED_LONG, MPI_MAX,
+		MPI_COMM_WORLD);
 
   initialize();
 
@@ -1665,46 +2011,44 @@ void Component::read_bodies_and_distribute_binary_out(istream *in)
 }
 
 
-void Component::openNextBlob(std::ifstream& in,
-			     std::list<std::string>::iterator& fit,
-			     int& N)
+namespace {
+  //! Stream buffer over an existing character array
+  struct PSPmembuf : std::streambuf
+  {
+    PSPmembuf(char* b, size_t n) { setg(b, b, b+n); }
+  };
+}
+
+size_t Component::pspRecordSize()
 {
-  in.close();			// Close current file
+  size_t fsize = rsize==sizeof(float) ? sizeof(float) : sizeof(double);
+  size_t recsz = fsize*8;	// mass + pos[3] + vel[3] + pot
 
-  std::string curfile;
+  if (indexing) recsz += sizeof(unsigned long);
 
-  try {
-    if (outdir.back() != '/')	// Check whether directory has trailing '/'
-      curfile = outdir + '/' + *fit;
-    else
-      curfile = outdir + *fit;
-    
-    in.open(curfile);
-  } catch (...) {
-    std::ostringstream sout;
-    sout << "Could not open SPL blob <" << curfile << ">";
-    throw GenericError(sout.str(), __FILE__, __LINE__, 1010, true);
-  }
+  return recsz + niattrib*sizeof(int) + ndattrib*fsize;
+}
 
-				// Double check file status
-  if (not in.good()) {
-    std::ostringstream sout;
-    sout << "Could not open SPL blob <" << curfile << ">";
-    throw GenericError(sout.str(), __FILE__, __LINE__, 1010, true);
-  }
+void Component::unpack_records(char* buf, size_t count, double& r2max)
+{
+  PSPmembuf mb(buf, count*pspRecordSize());
+  std::istream sin(&mb);
+
+  for (size_t i=0; i<count; i++) {
+    PartPtr part = std::make_shared<Particle>(niattrib, ndattrib);
+      
+    part->readBinary(rsize, indexing, ++seq_cur, &sin);
 
-				// Get particle count
-  try {
-    in.read((char*)&N, sizeof(unsigned int));
-  } catch (...) {
-    std::ostringstream sout;
-    sout << "Could not get particle count from <" << curfile << ">";
-    throw GenericError(sout.str(), __FILE__, __LINE__, 1010, true);
-  }
+    double r2 = 0.0;
+    for (int j=0; j<3; j++) r2 += part->pos[j]*part->pos[j];
+    r2max = std::max<double>(r2, r2max);
 
-  // Advance filename iterator
-  //
-  fit++;
+				// Load the particle
+    particles[part->indx] = part;
+
+				// Record top_seq
+    top_seq = std::max<unsigned long>(part->indx, top_seq);
+  }
 }
 
 
@@ -1770,7 +2114,7 @@ void Component::read_bodies_and_distribute_binary_spl(istream *in)
 
   // Broadcast attributes for this phase-space component
   //
-  MPI_Bcast(&nbodies_tot, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&nbodies_tot, 1, MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
   MPI_Bcast(&niattrib,    1, MPI_INT, 0, MPI_COMM_WORLD);
   MPI_Bcast(&ndattrib,    1, MPI_INT, 0, MPI_COMM_WORLD);
   MPI_Bcast(&ninfochar,   1, MPI_INT, 0, MPI_COMM_WORLD);
@@ -1870,129 +2214,106 @@ void Component::read_bodies_and_distribute_binary_spl(istream *in)
   
   // Get file names for split PSP parts
   //
-  std::list<std::string> parts;
-
-  if (myid==0) {
-    const size_t PBUF_SIZ = 1024;
-    char buf [PBUF_SIZ];
-
-    for (int n=0; n<number; n++) {
-      in->read((char *)buf, PBUF_SIZ);
-      parts.push_back(buf);
-    }
-  }
-
-  double rmax1=0.0, r2;
-
-  is_init = 1;
-  setup_distribution();
-  is_init = 0;
-				// Initialize the particle ferry
-				// instance with dynamic attribute
-				// sizes
-  if (not pf) pf = ParticleFerryPtr(new ParticleFerry(niattrib, ndattrib));
-
-				// Form cumulative and differential
-				// bodies list
-  unsigned int ipart=0;
+  const size_t PBUF_SIZ = 1024;
 
-  if (myid==0) {
-
-				// Set iterator to beginning of split list
-    auto fit = parts.begin();
+  MPI_Bcast(&number, 1, MPI_INT, 0, MPI_COMM_WORLD);
 
-    std::ifstream fin;		// Open file stream
-    int N;			// Number of particles in this stream
+  std::vector<char> names(number*PBUF_SIZ, 0);
 
-				// Get next blob (which is the first blob here)
-    openNextBlob(fin, fit, N);
+  if (myid==0) in->read(names.data(), number*PBUF_SIZ);
 
-    int fcount = 0;		// Count number of particles read from this stream
+  MPI_Bcast(names.data(), number*PBUF_SIZ, MPI_CHAR, 0, MPI_COMM_WORLD);
 
-				// Read root node particles
-    seq_cur = 0;
+  auto blobName = [&](int n)
+  {
+    std::string curfile(&names[n*PBUF_SIZ]);
+    if (outdir.back() != '/')	// Check whether directory has trailing '/'
+      curfile = outdir + '/' + curfile;
+    else
+      curfile = outdir + curfile;
+    return curfile;
+  };
 
-    rmax1 = 0.0;
-    for (unsigned i=1; i<=nbodies_table[0]; i++)
-    {
-      PartPtr part = std::make_shared<Particle>(niattrib, ndattrib);
-      
-      part->readBinary(rsize, indexing, ++seq_cur, &fin);
+  // The root gets the particle count in each blob
+  //
+  std::vector<unsigned> counts(number, 0);
 
-				// Check particle count in current split file
-      if (++fcount == N) {
-	fcount = N = 0;		// Maybe last particle . . .
-	if (fit != parts.end()) openNextBlob(fin, fit, N);
+  if (myid==0) {
+    for (int n=0; n<number; n++) {
+      std::ifstream fin(blobName(n));
+      if (fin.good()) fin.read((char*)&counts[n], sizeof(unsigned int));
+      if (not fin.good()) {
+	std::ostringstream sout;
+	sout << "Could not get particle count from <" << blobName(n) << ">";
+	throw GenericError(sout.str(), __FILE__, __LINE__, 1010, true);
       }
-
-      r2 = 0.0;
-      for (int j=0; j<3; j++) r2 += part->pos[j]*part->pos[j];
-      rmax1 = max<double>(r2, rmax1);
-
-				// Load the particle
-      particles[part->indx] = part;
-
-				// Record top_seq
-      top_seq = std::max<unsigned long>(part->indx, top_seq);
     }
+  }
 
-    nbodies = nbodies_table[0];
+  MPI_Bcast(counts.data(), number, MPI_UNSIGNED, 0, MPI_COMM_WORLD);
 
+  double r2max = 0.0;
 
-				// Now load the other nodes
-    unsigned icount;
-    for (int n=1; n<numprocs; n++) {
+  is_init = 1;
+  setup_distribution();
+  is_init = 0;
 
-      cout << "---- Component [" << name << "]: loading node <" << n << ">\n";
+  // Every process reads its own slice of the sequence directly from
+  // the blobs that hold it
+  //
+  size_t recsz = pspRecordSize();
+  unsigned long first = myid ? nbodies_index[myid-1] : 0;
+  unsigned long last  = nbodies_index[myid];
+  nbodies = nbodies_table[myid];
 
-      pf->ShipParticles(n, 0, nbodies_table[n]);
+  seq_cur = first;
+  top_seq = 0;
 
-      icount = 0;
-      while (icount < nbodies_table[n]) {
-	PartPtr part = std::make_shared<Particle>(niattrib, ndattrib);
+  const unsigned long chunk = std::max<unsigned long>(1, (1ul<<28)/recsz);
+  std::vector<char> buf;
 
-	part->readBinary(rsize, indexing, ++seq_cur, &fin);
+  unsigned long bbeg = 0;	// Sequence position of the current blob
+  for (int n=0; n<number; n++) {
+    unsigned long bend = bbeg + counts[n];
+    unsigned long lo = std::max<unsigned long>(bbeg, first);
+    unsigned long hi = std::min<unsigned long>(bend, last);
 
-				// Check particle count in current split file
-	if (++fcount == N) {
-	  fcount = N = 0;	// May be last particle . . .
-	  if (fit != parts.end()) openNextBlob(fin, fit, N);
-	}
+    if (lo < hi) {
+      std::ifstream fin(blobName(n));
+      fin.seekg(sizeof(unsigned int) + (lo - bbeg)*recsz);
 
-	r2 = 0.0;
-	for (int k=0; k<3; k++) 
-	  r2 += part->pos[k]*part->pos[k];
+      if (not fin.good()) {
+	std::ostringstream sout;
+	sout << "Could not open SPL blob <" << blobName(n) << ">";
+	throw GenericError(sout.str(), __FILE__, __LINE__, 1010, true);
+      }
 
-	rmax1 = max<double>(r2, rmax1);
+      for (unsigned long k=lo; k<hi; k+=chunk) {
+	unsigned long cnt = std::min<unsigned long>(chunk, hi-k);
+	buf.resize(cnt*recsz);
+	fin.read(buf.data(), cnt*recsz);
 
-	icount++;		// Send the particle
-	pf->SendParticle(part);
+	if (not fin.good()) {
+	  std::ostringstream sout;
+	  sout << "Error reading particles from SPL blob <"
+	       << blobName(n) << ">";
+	  throw GenericError(sout.str(), __FILE__, __LINE__, 1010, true);
+	}
 
-				// Record top_seq
-	top_seq = std::max<unsigned long>(part->indx, top_seq);
+	unpack_records(buf.data(), cnt, r2max);
       }
-
     }
 
-  } else {
-
-    pf->ShipParticles(myid, 0, nbodies);
-      
-    int icount = 0;
-    PartPtr part;
-    while ((part=pf->RecvParticle())) {
-      particles[part->indx] = part;
-      icount++;
-    }
+    bbeg = bend;
   }
 
-
 				// Default: set to max radius
-  rmax = sqrt(fabs(rmax1));
-  MPI_Bcast(&rmax, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+  MPI_Allreduce(MPI_IN_PLACE, &r2max, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+  rmax = sqrt(fabs(r2max));
 
-				// Send top_seq to all nodes
-  MPI_Bcast(&top_seq, 1, MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
+				// Share top_seq with all nodes
+  MPI_Allreduce(MPI_IN_PLACE, &top_seq, 1, MPI_UNSIGNED_LONG, MPI_MAX,
+		MPI_COMM_WORLD);
 
   initialize();
 
@@ -2015,8 +2336,8 @@ void Component::read_bodies_and_distribute_binary_spl(istream *in)
 
 PartPtr * Component::get_particles(int* number)
 {
-  static std::vector<unsigned> totals;
-  static unsigned counter = 0;	// Counter for all
+  static std::vector<unsigned long> totals;
+  static unsigned long counter = 0; // Counter for all
   static int      node    = 0;	// Current node
   
 				// Reset
@@ -2045,8 +2366,8 @@ PartPtr * Component::get_particles(int* number)
 
 				// Every process report particle numbers
     totals.resize(numprocs);
-    MPI_Allgather(&nbodies, 1, MPI_UNSIGNED, &totals[0], 1, MPI_UNSIGNED,
-		  MPI_COMM_WORLD);
+    MPI_Allgather(&nbodies, 1, MPI_UNSIGNED_LONG, &totals[0], 1,
+		  MPI_UNSIGNED_LONG, MPI_COMM_WORLD);
 				// Cumulate
     for (int n=1; n<numprocs; n++) totals[n] += totals[n-1];
   }
@@ -2054,9 +2375,9 @@ PartPtr * Component::get_particles(int* number)
 
   std::map<unsigned long, PartPtr> tlist;
 
-  unsigned icount;
-  unsigned beg = counter;
-  unsigned end = counter + PFbufsz;
+  unsigned long icount;
+  unsigned long beg = counter;
+  unsigned long end = counter + PFbufsz;
 
   bool complete = false;
   if (end >= totals[node]) {
@@ -2090,7 +2411,7 @@ PartPtr * Component::get_particles(int* number)
 
     } else {
       
-      unsigned number;
+      unsigned long number;
       pf->ShipParticles(0, node, number);
       
       icount = 0;
@@ -2132,7 +2453,7 @@ PartPtr * Component::get_particles(int* number)
 #endif    
   }
 
-  MPI_Bcast(&counter, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&counter, 1, MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
 
 				// Return values
   *number = curcount;
@@ -2506,9 +2827,12 @@ void Component::write_binary_mpi_b(MPI_File& out, MPI_Offset& offset, bool real4
   if (real4) rsize = sizeof(float);
   else       rsize = sizeof(double);
 
+  // All processes need the count to size a wide header
+  //
+  header.nbod  = nbodies_tot;
+
   if (myid == 0) {
 
-    header.nbod  = nbodies_tot;
     header.niatr = niattrib;
     header.ndatr = ndattrib;
   
@@ -2549,13 +2873,14 @@ void Component::write_binary_mpi_b(MPI_File& out, MPI_Offset& offset, bool real4
     offset += sizeof(unsigned long) + header.getSize();
   }
 
-  unsigned N = particles.size();
-  std::vector<unsigned> numP(numprocs, 0);
+  unsigned long N = particles.size();
+  std::vector<unsigned long> numP(numprocs, 0);
 
-  MPI_Allgather(&N, 1, MPI_UNSIGNED, &numP[0], 1, MPI_UNSIGNED,	MPI_COMM_WORLD);
+  MPI_Allgather(&N, 1, MPI_UNSIGNED_LONG, &numP[0], 1, MPI_UNSIGNED_LONG,
+		MPI_COMM_WORLD);
   
   for (int i=1; i<numprocs; i++) numP[i] += numP[i-1];
-  unsigned bSiz = particles.begin()->second->getMPIBufSize(rsize, indexing);
+  MPI_Offset bSiz = pspRecordSize();
   if (myid) offset += numP[myid-1] * bSiz;
   
   std::vector<char> buffer(pBufSiz*bSiz);
@@ -2600,6 +2925,92 @@ void Component::write_binary_mpi_b(MPI_File& out, MPI_Offset& offset, bool real4
 }
 
 
+void Component::stage_binary_mpi(AsyncWriter& out, int id, MPI_Offset& offset, bool real4)
+{
+  ComponentHeader header;
+
+  if (real4) rsize = sizeof(float);
+  else       rsize = sizeof(double);
+
+  header.nbod  = nbodies_tot;
+
+  if (myid == 0) {
+
+    header.niatr = niattrib;
+    header.ndatr = ndattrib;
+  
+    std::ostringstream outs;
+    outs << conf << std::endl;
+    strncpy(header.info.get(), outs.str().c_str(), header.ninfochar);
+
+    unsigned long cmagic = magic + rsize;
+
+    std::ostringstream hout;
+    hout.write((const char *)&cmagic, sizeof(unsigned long));
+
+    if (!header.write(&hout)) {
+      std::string msg("Component::stage_binary_mpi: Error staging particle header");
+      throw GenericError(msg, __FILE__, __LINE__, 1011, true);
+    }
+
+    std::string hbuf = hout.str();
+    memcpy(out.reserve(id, offset, hbuf.size()), hbuf.data(), hbuf.size());
+  }
+
+  offset += sizeof(unsigned long) + header.getSize();
+
+  unsigned long N = particles.size();
+  std::vector<unsigned long> numP(numprocs, 0);
+
+  MPI_Allgather(&N, 1, MPI_UNSIGNED_LONG, &numP[0], 1, MPI_UNSIGNED_LONG,
+		MPI_COMM_WORLD);
+  
+  for (int i=1; i<numprocs; i++) numP[i] += numP[i-1];
+  MPI_Offset bSiz = pspRecordSize();
+  if (myid) offset += numP[myid-1] * bSiz;
+  
+  // Stage in bunches of pBufSiz records; contiguous bunches are
+  // merged into a single write by AsyncWriter
+  //
+  auto it = particles.begin();
+  size_t left = particles.size();
+  while (left) {
+    size_t count = std::min<size_t>(pBufSiz, left);
+    left -= count;
+    char *buf = out.reserve(id, offset, bSiz*count);
+    for (size_t i=0; i<count; i++, it++)
+      buf += it->second->writeBinaryMPI(buf, rsize, indexing);
+    offset += bSiz*count;
+  }
+
+  // Position file offset at end of particles
+  //
+  offset += (numP[numprocs-1] - numP[myid]) * bSiz;
+}
+
+void Component::stage_binary_particles(AsyncWriter& out, int id, bool real4)
+{
+  if (real4) rsize = sizeof(float);
+  else       rsize = sizeof(double);
+
+  unsigned int N = particles.size();
+  memcpy(out.reserve(id, 0, sizeof(unsigned int)), &N, sizeof(unsigned int));
+
+  size_t offset = sizeof(unsigned int), bSiz = pspRecordSize();
+
+  auto it = particles.begin();
+  size_t left = particles.size();
+  while (left) {
+    size_t count = std::min<size_t>(pBufSiz, left);
+    left -= count;
+    char *buf = out.reserve(id, offset, bSiz*count);
+    for (size_t i=0; i<count; i++, it++)
+      buf += it->second->writeBinaryMPI(buf, rsize, indexing);
+    offset += bSiz*count;
+  }
+}
+
+
 void Component::write_binary_mpi_i(MPI_File& out, MPI_Offset& offset, bool real4)
 {
   ComponentHeader header;
@@ -2611,9 +3022,12 @@ void Component::write_binary_mpi_i(MPI_File& out, MPI_Offset& offset, bool real4
   if (real4) rsize = sizeof(float);
   else       rsize = sizeof(double);
 
+  // All processes need the count to size a wide header
+  //
+  header.nbod  = nbodies_tot;
+
   if (myid == 0) {
 
-    header.nbod  = nbodies_tot;
     header.niatr = niattrib;
     header.ndatr = ndattrib;
   
@@ -2654,13 +3068,14 @@ void Component::write_binary_mpi_i(MPI_File& out, MPI_Offset& offset, bool real4
     offset += sizeof(unsigned long) + header.getSize();
   }
 
-  unsigned N = particles.size();
-  std::vector<unsigned> numP(numprocs, 0);
+  unsigned long N = particles.size();
+  std::vector<unsigned long> numP(numprocs, 0);
 
-  MPI_Allgather(&N, 1, MPI_UNSIGNED, &numP[0], 1, MPI_UNSIGNED,	MPI_COMM_WORLD);
+  MPI_Allgather(&N, 1, MPI_UNSIGNED_LONG, &numP[0], 1, MPI_UNSIGNED_LONG,
+		MPI_COMM_WORLD);
   
   for (int i=1; i<numprocs; i++) numP[i] += numP[i-1];
-  unsigned bSiz = particles.begin()->second->getMPIBufSize(rsize, indexing);
+  MPI_Offset bSiz = pspRecordSize();
   if (myid) offset += numP[myid-1] * bSiz;
   
   DoubleBuf buffer(pBufSiz*bSiz);
@@ -3318,8 +3733,8 @@ int Component::round_up(double dnumb)
 void Component::setup_distribution(void)
 {
 				// Needed for both root and workers
-  nbodies_index = vector<unsigned int>(numprocs);
-  nbodies_table = vector<unsigned int>(numprocs);
+  nbodies_index = vector<unsigned long>(numprocs);
+  nbodies_table = vector<unsigned long>(numprocs);
 
   if (myid == 0) {
 
@@ -3330,10 +3745,10 @@ void Component::setup_distribution(void)
 
       if (n == 0)
 	nbodies_table[n] = nbodies_index[n] = 
-	  max<int>(1, min<int>((int)(comp->rates[n] * nbodies_tot), nbodies_tot));
+	  max<unsigned long>(1, min<unsigned long>((unsigned long)(comp->rates[n] * nbodies_tot), nbodies_tot));
       else {
 	if (n < numprocs-1)
-	  nbodies_index[n] = (int)(comp->rates[n] * nbodies_tot) + 
+	  nbodies_index[n] = (unsigned long)(comp->rates[n] * nbodies_tot) + 
 	    nbodies_index[n-1];
 	else
 	  nbodies_index[n] = nbodies_tot;
@@ -3377,8 +3792,8 @@ void Component::setup_distribution(void)
   }
 
 
-  MPI_Bcast(&nbodies_index[0], numprocs, MPI_INT, 0, MPI_COMM_WORLD);
-  MPI_Bcast(&nbodies_table[0], numprocs, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&nbodies_index[0], numprocs, MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&nbodies_table[0], numprocs, MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
 
 }
 
@@ -3392,22 +3807,28 @@ void Component::update_indices(void)
   // Gather current size from all processes
   //
   nbodies = particles.size();
-  MPI_Allgather(&nbodies, 1, MPI_UNSIGNED, nbodies_table.data(), 1, MPI_UNSIGNED,
-		MPI_COMM_WORLD);
+  MPI_Allgather(&nbodies, 1, MPI_UNSIGNED_LONG, nbodies_table.data(), 1,
+		MPI_UNSIGNED_LONG, MPI_COMM_WORLD);
 
   // Cumulate
   //
   nbodies_index[0] = nbodies_table[0];
-  for (int n=0; n<numprocs; n++)
+  for (int n=1; n<numprocs; n++)
     nbodies_index[n] = nbodies_index[n-1] + nbodies_table[n];
 
 }
 
 void Component::load_balance(void)
 {
+				// Redistribute by key ranges
+  if (sfc_type != SFC::none) {
+    sfc_order(false);
+    return;
+  }
+
   MPI_Status status;
-  vector<unsigned int> nbodies_index1(numprocs);
-  vector<unsigned int> nbodies_table1(numprocs);
+  vector<unsigned long> nbodies_index1(numprocs);
+  vector<unsigned long> nbodies_table1(numprocs);
   std::ofstream out, log;
 
   update_indices();		// Refresh particle counts
@@ -3421,10 +3842,10 @@ void Component::load_balance(void)
 
       if (n == 0)
 	nbodies_table1[n] = nbodies_index1[n] = 
-	  std::max<int>(1, min<int>((int)(comp->rates[n] * nbodies_tot), nbodies_tot));
+	  std::max<unsigned long>(1, min<unsigned long>((unsigned long)(comp->rates[n] * nbodies_tot), nbodies_tot));
       else {
 	if (n < numprocs-1)
-	  nbodies_index1[n] = (int)(comp->rates[n] * nbodies_tot) +  nbodies_index1[n-1];
+	  nbodies_index1[n] = (unsigned long)(comp->rates[n] * nbodies_tot) +  nbodies_index1[n-1];
 	else
 	  nbodies_index1[n] = nbodies_tot;
       
@@ -3485,8 +3906,8 @@ void Component::load_balance(void)
 
   }
 
-  MPI_Bcast(&nbodies_index1[0], numprocs, MPI_INT, 0, MPI_COMM_WORLD);
-  MPI_Bcast(&nbodies_table1[0], numprocs, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&nbodies_index1[0], numprocs, MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&nbodies_table1[0], numprocs, MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
 
 				// Compute index
   loadb.clear();
@@ -3562,12 +3983,10 @@ void Component::load_balance(void)
 
   int iold=0, inew=0;
   
-				// Offset will keep track of position in
-				// original vector
-  int nump;
-  std::vector<int> loc(numprocs, 0);
-
-  std::vector<PartPtr> nlist;
+				// Number of particles to be shifted
+  unsigned long nump;
+				// Particles to ship to each process
+  std::vector<int> nsend(numprocs, 0);
 
   for (int i=0; i<2*numprocs-2; i++) {
 
@@ -3588,37 +4007,17 @@ void Component::load_balance(void)
     
     if (inew==iold || nump==0) 
       msg << "Do nothing";
-    else if (inew>iold) {
-      msg << "Add " << nump << " from #" << iold << " to #" << inew;
-      
-      nlist.clear();
-
-      PartMap::iterator it = particles.begin();
-      for (int n=0; n<nump; n++) {
-	nlist.push_back(it->second);
-	it++;
-      }
-      
-      add_particles(iold, inew, nlist);
-      
-    } else if (iold>inew) {
+    else {
       msg << "Add " << nump << " from #" << iold << " to #" << inew;
-
-      nlist.clear();
-
-      PartMapItr it = particles.begin();
-      for (int n=0; n<nump; n++) {
-	nlist.push_back(it->second);
-	it++;
-      }
-
-      add_particles(iold, inew, nlist);
-
+      if (myid==iold) nsend[inew] += nump;
     }
 
     if (myid==0 && log.good()) log << setw(10) << msg.str() << endl;
   }
 
+				// Ship all intervals in one exchange
+  bulk_exchange(nsend);
+
   
 				// update indices
   nbodies = nbodies_table1[myid];
@@ -3639,93 +4038,196 @@ void Component::load_balance(void)
 }
 
 
-template< typename T >
-typename std::vector<T>::iterator 
-insert_sorted( std::vector<T> & vec, T const& item )
+void Component::load_balance_cost(void)
 {
-  return vec.insert
-    ( 
-     std::upper_bound( vec.begin(), vec.end(), item ),
-     item 
-      );
+  // Mean force time per particle evaluation for this component over
+  // all processes.  This is the force-type weight of the cost model.
+  //
+  double z[2] = {cost_time, static_cast<double>(cost_evals)}, t[2];
+  MPI_Allreduce(z, t, 2, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+
+  double unit = t[1]>0.0 ? t[0]/t[1] : 1.0;
+  if (unit<=0.0) unit = 1.0;
+
+  // Predicted cost per master step: a particle on level l is
+  // evaluated 2^l times.  The prediction is kept in the particle's
+  // effort and travels with it.
+  //
+  double work = 0.0;
+  for (auto & p : particles) {
+    p.second->effort = unit * static_cast<double>(1u << p.second->level);
+    work += p.second->effort;
+  }
+
+  // Split the space-filling curve by predicted work instead
+  //
+  if (sfc_type != SFC::none) {
+    sfc_order(true);
+    return;
+  }
+
+  std::vector<double> W(numprocs);
+  MPI_Allgather(&work, 1, MPI_DOUBLE, W.data(), 1, MPI_DOUBLE, MPI_COMM_WORLD);
+
+  double Wtot = 0.0;
+  for (auto w : W) Wtot += w;
+  if (Wtot<=0.0) return;
+
+  // Current and target cumulative work boundaries.  The overlap of
+  // this process' current interval with the target interval of
+  // process n is the work to send to n.
+  //
+  std::vector<double> A(numprocs+1, 0.0), B(numprocs+1, 0.0);
+  for (int n=0; n<numprocs; n++) {
+    A[n+1] = A[n] + W[n];
+    B[n+1] = B[n] + comp->rates[n]*Wtot;
+  }
+  B[numprocs] = Wtot;
+
+  std::vector<double> owe(numprocs, 0.0);
+  for (int n=0; n<numprocs; n++) {
+    if (n==myid) continue;
+    double lo = std::max<double>(A[myid], B[n]);
+    double hi = std::min<double>(A[myid+1], B[n+1]);
+    if (hi>lo) owe[n] = hi - lo;
+  }
+
+  // Count particles to meet each amount in the map order used by
+  // bulk_exchange
+  //
+  std::vector<int> nsend(numprocs, 0);
+  auto it = particles.begin();
+  for (int n=0; n<numprocs and it!=particles.end(); n++) {
+    double sent = 0.0;
+    while (it!=particles.end() and sent + 0.5*it->second->effort < owe[n]) {
+      sent += it->second->effort;
+      nsend[n]++;
+      it++;
+    }
+  }
+
+  if (myid==0 and VERBOSE>3) {
+    double wmax = *std::max_element(W.begin(), W.end());
+    std::cout << "Component::load_balance_cost <" << name
+	      << ">: max/mean predicted work=" << wmax*numprocs/Wtot
+	      << std::endl;
+  }
+
+  bulk_exchange(nsend);
+
+  update_indices();
 }
 
-void Component::add_particles(int from, int to, std::vector<PartPtr>& plist)
+
+void Component::bulk_exchange(std::vector<int>& nsend)
 {
-  unsigned number = plist.size();
-  std::vector<PartPtr>::iterator it=plist.begin();
+  // Select the outgoing particles by destination
+  //
+  std::vector<std::vector<PartPtr>> out(numprocs);
 
-  unsigned icount, counter=0;
+  PartMapItr it = particles.begin();
+  for (int n=0; n<numprocs; n++) {
+    for (int k=0; k<nsend[n] and it!=particles.end(); k++, it++) {
+      out[n].push_back(it->second);
+    }
+  }
 
-  pf->ShipParticles(to, from, number);
+  bulk_exchange(out);
+}
 
-  if (myid == from) {
-    
-    while (counter < number) {
 
-      icount = 0;
-      while (icount < PFbufsz && counter < number) {
-
-	pf->SendParticle(*it);
-
-	// Remove particle from lev list
-	//
-	bool success = false;	// Sanity check
-	for (auto & v : levlist) {
-	  auto jt = std::find(v.begin(), v.end(), (*it)->indx);
-	  if (jt != v.end()) {
-	    v.erase(jt);
-	    success = true;
-	    break;
-	  }
-	}
+void Component::bulk_exchange(std::vector<std::vector<PartPtr>>& out)
+{
+  // Initialize the particle ferry instance with dynamic attribute sizes
+  if (not pf) pf = ParticleFerryPtr(new ParticleFerry(niattrib, ndattrib));
 
-	// Levlist sanity check
-	//
-	if (not success) {
-	  std::cout << "***ERROR*** "
-		    << "Component::add_particles: could not find indx="
-		    << (*it)->indx << " in levlist in any of "
-		    << multistep+1 << " levels" << std::endl;
-	}
+  std::unordered_set<unsigned long> gone;
+  for (auto & v : out) {
+    for (auto & p : v) gone.insert(p->indx);
+  }
 
-	particles.erase((*it)->indx);
-      
-	icount++;
-	counter++;
-	it++;
-      }
-      
-#ifdef DEBUG
-      cout << "Process " << myid 
-	   << ": sent " << icount << " particles to Process " << to
-	   << " for append, counter value=" << counter
-	   << endl << flush;
-#endif    
+  // Remove them from the level lists and the particle map
+  //
+  if (gone.size()) {
+    for (auto & v : levlist) {
+      v.erase(std::remove_if(v.begin(), v.end(),
+			     [&gone](int i) { return gone.count(i)>0; }),
+	      v.end());
     }
+    for (auto i : gone) particles.erase(i);
+  }
 
+  // Exchange and add the arrivals to the map and level lists
+  //
+  std::vector<bool> touched(levlist.size(), false);
+
+  auto arrivals = pf->Exchange(out);
+
+  for (auto & part : arrivals) {
+    particles[part->indx] = part;
+    levlist[part->level].push_back(part->indx);
+    touched[part->level] = true;
   }
 
-  if (myid == to) {
-  
-    while (counter < number) {
+  for (unsigned l=0; l<levlist.size(); l++) {
+    if (touched[l]) std::sort(levlist[l].begin(), levlist[l].end());
+  }
 
-      while (PartPtr temp=pf->RecvParticle()) {
-	particles[temp->indx] = temp;
-	insert_sorted<int>(levlist[temp->level], temp->indx);
-	counter++;
-      }
+  track_block(arrivals);
+  arrivals.clear();
+  compact_blocks();
+}
 
-#ifdef DEBUG
-      cout << "Process " << myid 
-	   << ": received " << icount << " particles from Process " << from
-	   << " for append" << endl << flush;
-#endif    
 
+void Component::track_block(const std::vector<PartPtr>& parts)
+{
+  if (parts.size()) blocks.push_back({std::weak_ptr<void>(parts[0]), parts.size()});
+}
+
+
+void Component::compact_blocks()
+{
+  // Live particle count of each block from the shared ownership
+  // count; drop the released blocks and find the sparse ones
+  //
+  std::set<std::weak_ptr<void>, std::owner_less<std::weak_ptr<void>>> sparse;
+  size_t nlive = 0;
+
+  auto it = blocks.begin();
+  while (it != blocks.end()) {
+    size_t live = it->first.use_count();
+    if (live == 0) {
+      it = blocks.erase(it);
+    } else if (2*live < it->second) {
+      sparse.insert(it->first);
+      nlive += live;
+      it = blocks.erase(it);
+    } else {
+      it++;
     }
+  }
+
+  if (sparse.empty()) return;
+
+  // Copy the survivors into one new block
+  //
+  auto block = std::make_shared<std::vector<Particle>>();
+  block->reserve(nlive);
 
+  std::vector<PartPtr*> moved;
+  moved.reserve(nlive);
+
+  for (auto & p : particles) {
+    if (sparse.count(std::weak_ptr<void>(p.second)) == 0) continue;
+    if (block->size() == block->capacity()) break; // Extra owners
+    block->push_back(*p.second);
+    moved.push_back(&p.second);
   }
 
+  for (size_t k=0; k<moved.size(); k++)
+    *moved[k] = PartPtr(block, &(*block)[k]);
+
+  blocks.push_back({std::weak_ptr<void>(block), block->size()});
 }
 
 
@@ -3763,63 +4265,41 @@ void Component::redistributeByList(vector<int>& redist)
   // Initialize the particle ferry instance with dynamic attribute sizes
   if (not pf) pf = ParticleFerryPtr(new ParticleFerry(niattrib, ndattrib));
 
+  // Every process holds the full list: collect the particles that
+  // this process owns by destination
+  //
+  std::vector<std::vector<PartPtr>> out(numprocs);
 
   vector<int>::iterator it = redist.begin();
-  vector<unsigned> tlist;
 
-  PartPtr part;
-  unsigned int icount;
-  int indx, curnode, tonode, lastnode, M;
+  int indx, curnode, tonode, M;
 
   while (it != redist.end()) {
     curnode = *(it++);		// Current owner
     M       = *(it++);		// Number to transfer to another node
-    if (M) {
+
+    for (int m=0; m<M; m++) {
       indx   = *(it++);		// Index
       tonode = *(it++);		// Destination
-      icount = 0;		// Number transferred to destination
-
-
-      // Do the first particle
-      //
-      tlist.clear();
-      tlist.push_back(indx);
-      icount++;
-
-      lastnode = tonode;
-
-      // Do the remaining particles
-      //
-      for (int m=1; m<M; m++) {
-	indx   = *(it++);
-	tonode = *(it++);
-				// Next destination?
-	if (tonode != lastnode && icount) {
-	  pf->ShipParticles(tonode, curnode, icount);
-
-	  if (myid==curnode) {
-	    for (unsigned i=0; i<icount; i++) {
-	      pf->SendParticle(particles[tlist[i]]);
-	      particles.erase(tlist[i]);
-	    }
-	  }
-	  if (myid==lastnode) {
-	    while ((part=pf->RecvParticle()))
-	      particles[part->indx] = part;
-	  }
-	  tlist.clear();
-	  icount = 0;
-	}
 
-				// Add the particle
-	tlist.push_back(indx);
-	icount++;
-      }
-	
-    } // End of particles on this node
+      if (myid==curnode and tonode!=curnode)
+	out[tonode].push_back(particles[indx]);
+    }
     
   } // Next stanza
 
+  for (auto & v : out) {
+    for (auto & p : v) particles.erase(p->indx);
+  }
+
+  // Ship everything in one round
+  //
+  auto arrivals = pf->Exchange(out);
+  for (auto & part : arrivals) particles[part->indx] = part;
+
+  track_block(arrivals);
+  arrivals.clear();
+  compact_blocks();
 }
 
 
@@ -3847,7 +4327,7 @@ void Component::seq_new_particles()
   // Update total number of bodies
   //
   nbodies = particles.size();
-  MPI_Allreduce(&nbodies, &nbodies_tot, 1, MPI_UNSIGNED, MPI_SUM,
+  MPI_Allreduce(&nbodies, &nbodies_tot, 1, MPI_UNSIGNED_LONG, MPI_SUM,
 		MPI_COMM_WORLD);
 
   // Are there new particles to sequence?
@@ -3889,7 +4369,7 @@ void Component::seq_new_particles()
   // Update total number of bodies
   //
   nbodies = particles.size();
-  MPI_Allreduce(&nbodies, &nbodies_tot, 1, MPI_UNSIGNED, MPI_SUM,
+  MPI_Allreduce(&nbodies, &nbodies_tot, 1, MPI_UNSIGNED_LONG, MPI_SUM,
 		MPI_COMM_WORLD);
 
 #ifdef DEBUG
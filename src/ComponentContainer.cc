@@ -11,6 +11,8 @@
 #include <ComponentContainer.H>
 #include <ExternalCollection.H>
 #include <StringTok.H>
+#include <ChkptDelta.H>
+#include <Profile.H>
 
 #ifdef USE_GPTL
 #include <gptl.h>
@@ -20,6 +22,16 @@
 
 long ComponentContainer::tinterval = 300;	// Seconds between timer dumps
 
+// Number of particles on levels [mlevel, multistep] for the profile
+//
+static unsigned long active_count(Component* c, int mlevel)
+{
+  unsigned long n = 0;
+  for (unsigned lev=mlevel; lev<c->levlist.size(); lev++)
+    n += c->levlist[lev].size();
+  return n;
+}
+
 ComponentContainer::ComponentContainer(void)
 {
   gottapot      = false;
@@ -118,10 +130,20 @@ void ComponentContainer::initialize(void)
 
     MPI_Bcast(&tnow,  1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
 
-    MPI_Bcast(&ntot,  1, MPI_INT,    0, MPI_COMM_WORLD);
+    MPI_Bcast(&ntot,  1, MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
       
     MPI_Bcast(&ncomp, 1, MPI_INT,    0, MPI_COMM_WORLD);
       
+				// Look for incremental checkpoint
+				// deltas.  The time is advanced to the
+				// delta before the components are
+				// constructed so that their COM and
+				// orientation logs are restored to it.
+    ChkptDelta::Latest delta;
+    if (not ignore_info) {
+      delta = ChkptDelta::latest(outdir + infile, tnow);
+      if (delta.seq >= 0) tnow = delta.time;
+    }
 
     YAML::Node comp = parse["Components"];
 
@@ -141,6 +163,9 @@ void ComponentContainer::initialize(void)
 		<< outdir + infile << ">: " << e.what() << std::endl;
     }
 
+				// Apply incremental checkpoint deltas
+    ChkptDelta::replay(outdir + infile, delta, this);
+
   } else {
     
     YAML::Node comp = parse["Components"];
@@ -536,6 +561,9 @@ void ComponentContainer::compute_potential(unsigned mlevel)
 	    for (int k=0; k<c->dim; k++) c->Part(indx)->acc[k] = 0.0;
 	  }
 	}
+				// Pack the active levels for force
+				// methods using the slot interface
+	c->ParticlesToSoA(mlevel);
       }
     //
     // END: zero pot and accel loop
@@ -556,6 +584,10 @@ void ComponentContainer::compute_potential(unsigned mlevel)
     }
     c->time_so_far.start();
 
+    Profile::Scope prof;
+    if (Profile::enabled())
+      prof.begin("force." + c->name, active_count(c, mlevel));
+
     if (cuda_prof) {
       std::ostringstream sout; sout << "ComponentContainer::set_multistep [" << c->name << "]";
       tPtr1.reset();
@@ -590,6 +622,14 @@ void ComponentContainer::compute_potential(unsigned mlevel)
     }
 
     c->time_so_far.stop();
+
+				// Accumulate cost-model statistics
+    if (costbalance) {
+      c->cost_time += c->time_so_far.getTime();
+      for (int lev=mlevel; lev<=multistep; lev++)
+	c->cost_evals += c->levlist[lev].size();
+    }
+
     if (timing) {
       timer_accel.stop();
       timer_wait.start();
@@ -690,8 +730,15 @@ void ComponentContainer::compute_potential(unsigned mlevel)
       other->time_so_far.start();
       inter->c->force->SetExternal();
 
-      inter->c->force->set_multistep_level(mlevel);
-      inter->c->force->get_acceleration_and_potential(other);
+      {
+	Profile::Scope prof;
+	if (Profile::enabled())
+	  prof.begin("inter." + inter->c->name + "->" + other->name,
+		     active_count(other, mlevel));
+
+	inter->c->force->set_multistep_level(mlevel);
+	inter->c->force->get_acceleration_and_potential(other);
+      }
 
       inter->c->force->ClearExternal();
       other->time_so_far.stop();
@@ -728,6 +775,11 @@ void ComponentContainer::compute_potential(unsigned mlevel)
 
   if (timing) timer_inter.stop();
       
+  //
+  // Return the slot accumulated forces to the particles
+  //
+  for (auto c : components) c->SoAToParticles();
+
 #ifdef USE_GPTL
   GPTLstop ("ComponentContainer::interactions");
 #ifdef GPTL_WAIT
@@ -1078,6 +1130,10 @@ void ComponentContainer::compute_expansion(unsigned mlevel)
     cout << "Process " << myid << ": about to compute coefficients <"
 	 << c->id << "> for mlevel=" << mlevel << endl;
 #endif
+    Profile::Scope prof;
+    if (Profile::enabled())
+      prof.begin("coef." + c->name, active_count(c, mlevel));
+
 				// Compute coefficients
     c->force->set_multistep_level(mlevel);
 
@@ -1090,7 +1146,9 @@ void ComponentContainer::compute_expansion(unsigned mlevel)
       c->ParticlesToCuda();
 #endif
     } else {
+      c->ParticlesToSoA(mlevel);
       c->force->determine_coefficients(c);
+      c->SoAToParticles();
     }
 
 #ifdef DEBUG
@@ -1380,6 +1438,12 @@ void ComponentContainer::load_balance(void)
 {
   if (!nbalance || this_step % nbalance)  return;
 
+				// Use the per-particle cost model
+  if (costbalance) {
+    load_balance_cost();
+    return;
+  }
+
 				// Query timers
   vector<double> rates1(numprocs, 0.0), trates(numprocs, 0.0);
   rates1[myid] = MPL_read_timer(1);
@@ -1467,6 +1531,77 @@ void ComponentContainer::load_balance(void)
 
 }
 
+void ComponentContainer::load_balance_cost(void)
+{
+				// Force time on each process since
+				// the last check
+  double mytime = 0.0;
+  for (auto c : components) mytime += c->cost_time;
+
+  std::vector<double> times(numprocs);
+  MPI_Allgather(&mytime, 1, MPI_DOUBLE, times.data(), 1, MPI_DOUBLE,
+		MPI_COMM_WORLD);
+
+  double total = 0.0;
+  for (auto t : times) total += t;
+
+				// Largest excess of a process' share of
+				// the force time over its rate
+  double excess = 0.0;
+  if (total>0.0) {
+    for (int n=0; n<numprocs; n++) {
+      if (rates[n]>0.0)
+	excess = std::max<double>(excess, times[n]/(rates[n]*total) - 1.0);
+    }
+  }
+
+  bool toobig = excess > dbthresh;
+
+				// Print out info
+  if (myid==0) {
+    
+    string outrates = outdir + "current.processor.cost." + runtag;
+
+    ofstream out(outrates.c_str(), ios::out | ios::app);
+    if (out) {
+      out << "# Step: " << this_step << " Time: " << tnow
+	  << " Excess: " << excess
+	  << (toobig ? " (rebalance)" : "") << endl;
+      out << "# "
+	  << setw(5)  << "Proc"
+	  << setw(15) << "Force time"
+	  << setw(15) << "Time frac"
+	  << setw(15) << "Rate"
+	  << endl
+	  << "# "
+	  << setw(5)  << "-----"
+	  << setw(15) << "----------"
+	  << setw(15) << "----------"
+	  << setw(15) << "----------"
+	  << endl;
+      
+      for (int n=0; n<numprocs; n++) {
+	out << "  "
+	    << setw(5)  << n
+	    << setw(15) << times[n]
+	    << setw(15) << (total>0.0 ? times[n]/total : 0.0)
+	    << setw(15) << rates[n]
+	    << endl;
+      }
+    }
+  }
+
+  if (toobig) {
+    for (auto c : components) c->load_balance_cost();
+  }
+
+				// Begin a new measurement interval
+  for (auto c : components) {
+    c->cost_time  = 0.0;
+    c->cost_evals = 0;
+  }
+}
+
 bool ComponentContainer::bad_values()
 {
   bool bad = false;
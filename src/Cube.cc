@@ -3,8 +3,14 @@
 #include <filesystem>
 #include <cstdlib>
 #include <cmath>
+#include <limits>
 
 #include <Cube.H>
+#include <ThreadPool.H>
+
+#ifdef HAVE_FFTW
+#include <fftw3.h>
+#endif
 
 const std::set<std::string>
 Cube::valid_keys = {
@@ -14,7 +20,9 @@ Cube::valid_keys = {
   "nmaxx",
   "nmaxy",
   "nmaxz",
-  "method"
+  "method",
+  "pmesh",
+  "pmAssign"
 };
 
 //@{
@@ -32,6 +40,8 @@ Cube::Cube(Component* c0, const YAML::Node& conf) : PotAccel(c0, conf)
   coef_dump  = true;
   byPlanes   = true;
   cuMethod   = "planes";
+  pmesh      = 0;
+  pmAssign   = "CIC";
 
   // Default parameter values
   //
@@ -53,6 +63,58 @@ Cube::Cube(Component* c0, const YAML::Node& conf) : PotAccel(c0, conf)
   imz   = 1 + 2*nmaxz;		// number of x wave numbers
   osize = imx * imy * imz;	// total number of coefficients
 
+  // Particle-mesh mode
+  //
+  if (pmesh) {
+#ifndef HAVE_FFTW
+    throw GenericError("Cube: the particle-mesh mode (pmesh>0) requires FFTW",
+		       __FILE__, __LINE__, 1019, false);
+#endif
+    if (pmesh <= 2*std::max<int>(nmaxx, std::max<int>(nmaxy, nmaxz))) {
+      std::ostringstream sout;
+      sout << "Cube: pmesh=" << pmesh << " must exceed 2*nmax to represent "
+	   << "all wave numbers";
+      throw GenericError(sout.str(), __FILE__, __LINE__, 1019, false);
+    }
+
+    if      (pmAssign == "CIC") pmOrder = 2;
+    else if (pmAssign == "TSC") pmOrder = 3;
+    else {
+      std::ostringstream sout;
+      sout << "Cube: unknown pmAssign <" << pmAssign << ">; use CIC or TSC";
+      throw GenericError(sout.str(), __FILE__, __LINE__, 1019, false);
+    }
+
+    size_t msize = static_cast<size_t>(pmesh)*pmesh*pmesh;
+
+    // The mesh is reduced across processes in one MPI call
+    //
+    if (msize > static_cast<size_t>(std::numeric_limits<int>::max())) {
+      std::ostringstream sout;
+      sout << "Cube: pmesh=" << pmesh << " gives " << msize
+	   << " mesh nodes, more than an MPI count can address";
+      throw GenericError(sout.str(), __FILE__, __LINE__, 1019, false);
+    }
+
+    pmRho.resize(msize, 0.0);
+
+    // Each thread owns a slab of x planes of the shared mesh
+    //
+    pmSlab.resize(nthrds+1);
+    for (int n=0; n<=nthrds; n++) pmSlab[n] = pmesh*n/nthrds;
+
+    pmOwner.resize(pmesh);
+    for (int n=0; n<nthrds; n++)
+      for (int i=pmSlab[n]; i<pmSlab[n+1]; i++) pmOwner[i] = n;
+
+    pmBin.resize(nthrds);
+    for (auto & v : pmBin) v.resize(nthrds);
+
+#if HAVE_LIBCUDA==1
+    cuda_aware = false;		// Particle-mesh is host only
+#endif
+  }
+
   // Allocate storage
   //
   expcoef.resize(nthrds);
@@ -114,6 +176,8 @@ void Cube::initialize(void)
     if (conf["nmaxy" ])  nmaxy      = conf["nmaxy" ].as<int>();
     if (conf["nmaxz" ])  nmaxz      = conf["nmaxz" ].as<int>();
     if (conf["method"])  cuMethod   = conf["method"].as<std::string>();
+    if (conf["pmesh" ])  pmesh      = conf["pmesh" ].as<int>();
+    if (conf["pmAssign"]) pmAssign  = conf["pmAssign"].as<std::string>();
   }
   catch (YAML::Exception & error) {
     if (myid==0) std::cout << "Error parsing parameters in Cube: "
@@ -149,24 +213,58 @@ void * Cube::determine_coefficients_thread(void * arg)
     int nbeg = nbodies*(id  )/nthrds;
     int nend = nbodies*(id+1)/nthrds;
 
+				// Use the slot mirror if packed
+    bool soa = cC->SoA(lev);
+    unsigned sbeg = soa ? cC->SoABeg(lev) : 0;
+
     for (int q=nbeg; q<nend; q++) {
 
-      int i = cC->levlist[lev][q];
+      double mass, x, y, z;
 
-      use[id]++;
-      double mass = cC->Mass(i) * adb;
+      if (soa) {
+	unsigned s = sbeg + q;
 
-      // Get position
-      //
-      double x = cC->Pos(i, 0);
-      double y = cC->Pos(i, 1);
-      double z = cC->Pos(i, 2);
+	mass = cC->SoAMass(s) * adb;
+	x    = cC->SoAPos(s, 0);
+	y    = cC->SoAPos(s, 1);
+	z    = cC->SoAPos(s, 2);
+      } else {
+	int i = cC->levlist[lev][q];
+
+	mass = cC->Mass(i) * adb;
+	x    = cC->Pos(i, 0);
+	y    = cC->Pos(i, 1);
+	z    = cC->Pos(i, 2);
+      }
+
+      use[id]++;
 
       // Only compute for points inside the unit cube
       //
       if (x<0.0 or x>1.0) continue;
       if (y<0.0 or y>1.0) continue;
       if (z<0.0 or z>1.0) continue;
+
+      // Particle-mesh mode: bin the particle for each thread that
+      // owns one of its stencil planes; the mass is assigned to the
+      // mesh by the owners in pm_coefficients()
+      //
+      if (pmesh) {
+	int ix[3];
+	double wx[3];
+
+	pm_weights(x, ix, wx);
+
+	int last = -1;
+	for (int a=0; a<pmOrder; a++) {
+	  int o = pmOwner[ix[a]];
+	  if (o == last) continue;
+	  pmBin[id][o].push_back({x, y, z, mass});
+	  last = o;
+	}
+
+	continue;
+      }
       
       // Recursion multipliers
       //
@@ -222,6 +320,7 @@ void Cube::determine_coefficients(void)
   // Clean  the coefficients
   //
   for (auto & v : expcoef) v.setZero();
+  for (auto & v : pmBin) for (auto & b : v) b.clear();
 
   // Swap interpolation arrays
   //
@@ -260,6 +359,10 @@ void Cube::determine_coefficients(void)
   exp_thread_fork(true);
 #endif
 
+  // Transform the mesh to get the coefficients
+  //
+  if (pmesh) pm_coefficients();
+
   for (int i=0; i<nthrds; i++) use1 += use[i];
   
   MPI_Allreduce ( &use1, &use0,  1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
@@ -347,20 +450,59 @@ void * Cube::determine_acceleration_and_potential_thread(void * arg)
   int nbeg = nbodies*id/nthrds;
   int nend = nbodies*(id+1)/nthrds;
 
+  // Every particle is updated, so the slot mirror is only usable
+  // when all levels are packed
+  //
+  bool soa = cC->SoA(0) and cC->SoAEnd(multistep) == nbodies;
+
   PartMapItr it = cC->Particles().begin();
-  unsigned long i;
+  unsigned long i = 0;
 
-  for (int q=0; q<nbeg; q++) it++;
+  if (not soa) for (int q=0; q<nbeg; q++) it++;
   for (int q=nbeg; q<nend; q++) {
     
-    i = it->first; it++;
+    if (not soa) { i = it->first; it++; }
 
     std::complex<double> accx(0), accy(0), accz(0), dens(0), potl(0);
     
     // Get positions
-    double x = cC->Pos(i, 0);
-    double y = cC->Pos(i, 1);
-    double z = cC->Pos(i, 2);
+    double x = soa ? cC->SoAPos(q, 0) : cC->Pos(i, 0);
+    double y = soa ? cC->SoAPos(q, 1) : cC->Pos(i, 1);
+    double z = soa ? cC->SoAPos(q, 2) : cC->Pos(i, 2);
+
+    // Particle-mesh mode: interpolate the fields from the meshes
+    //
+    if (pmesh) {
+      int ix[3], iy[3], iz[3];
+      double wx[3], wy[3], wz[3];
+
+      pm_weights(x, ix, wx);
+      pm_weights(y, iy, wy);
+      pm_weights(z, iz, wz);
+
+      double acc[3] = {0.0, 0.0, 0.0}, pot = 0.0;
+
+      for (int a=0; a<pmOrder; a++) {
+	for (int b=0; b<pmOrder; b++) {
+	  for (int c=0; c<pmOrder; c++) {
+	    size_t n = pm_node(ix[a], iy[b], iz[c]);
+	    double w = wx[a]*wy[b]*wz[c];
+	    for (int k=0; k<3; k++) acc[k] += w*pmAcc[k][n];
+	    pot += w*pmPot[n];
+	  }
+	}
+      }
+
+      if (soa) {
+	for (int k=0; k<3; k++) cC->SoAAddAcc(q, k, acc[k]);
+	cC->SoAAddPot(q, pot);
+      } else {
+	cC->AddAcc(i, acc);
+	cC->AddPot(i, pot);
+      }
+
+      continue;
+    }
 
     // Recursion multipliers
     auto stepx = std::exp(kfac*x);
@@ -409,11 +551,19 @@ void * Cube::determine_acceleration_and_potential_thread(void * arg)
       }
     }
     
-    cC->AddAcc(i, 0, accx.real());
-    cC->AddAcc(i, 1, accy.real());
-    cC->AddAcc(i, 2, accz.real());
+    if (soa) {
+      cC->SoAAddAcc(q, 0, accx.real());
+      cC->SoAAddAcc(q, 1, accy.real());
+      cC->SoAAddAcc(q, 2, accz.real());
+
+      cC->SoAAddPot(q, potl.real());
+    } else {
+      cC->AddAcc(i, 0, accx.real());
+      cC->AddAcc(i, 1, accy.real());
+      cC->AddAcc(i, 2, accz.real());
 
-    cC->AddPot(i, potl.real());
+      cC->AddPot(i, potl.real());
+    }
   }
   
   return (NULL);
@@ -450,6 +600,10 @@ void Cube::determine_acceleration_and_potential(void)
 
   }
 
+  // Make the potential and acceleration meshes
+  //
+  if (pmesh) pm_fields();
+
 #if HAVE_LIBCUDA==1
   if (use_cuda and cC->cudaDevice>=0 and cC->force->cudaAware()) {
     if (cudaAccelOverride) {
@@ -523,6 +677,7 @@ void Cube::dump_coefs_h5(const std::string& file)
     // And the new coefficients and write the new HDF5
     cubeCoefs.clear();
     cubeCoefs.add(cur);
+    cubeCoefs.setH5Layout(h5series, h5chunk, h5deflate, h5shuffle);
     cubeCoefs.WriteH5Coefs(file);
   }
 }
@@ -676,3 +831,196 @@ void Cube::compute_multistep_coefficients()
   }
 }
 
+
+void Cube::pm_weights(double x, int* indx, double* wght)
+{
+  double u = x*pmesh;
+
+  if (pmOrder==2) {		// Cloud in cell
+    int i = static_cast<int>(std::floor(u));
+    double d = u - i;
+    indx[0] = i;   wght[0] = 1.0 - d;
+    indx[1] = i+1; wght[1] = d;
+  } else {			// Triangular shaped cloud
+    int i = static_cast<int>(std::floor(u + 0.5));
+    double d = u - i;
+    indx[0] = i-1; wght[0] = 0.5*(0.5 - d)*(0.5 - d);
+    indx[1] = i;   wght[1] = 0.75 - d*d;
+    indx[2] = i+1; wght[2] = 0.5*(0.5 + d)*(0.5 + d);
+  }
+
+  // Periodic wrap
+  //
+  for (int j=0; j<pmOrder; j++) {
+    indx[j] %= pmesh;
+    if (indx[j]<0) indx[j] += pmesh;
+  }
+}
+
+double Cube::pm_window(int k)
+{
+  if (k==0) return 1.0;
+  double arg = M_PI*k/pmesh;
+  return std::pow(std::sin(arg)/arg, pmOrder);
+}
+
+void Cube::pm_coefficients()
+{
+#ifdef HAVE_FFTW
+  int N = pmesh, Nh = pmesh/2 + 1;
+
+  // Assign the binned particles to the shared mesh.  Each thread
+  // clears and fills only its own slab of x planes, so no two
+  // threads write the same node.
+  //
+  auto & rho = pmRho;
+  size_t plane = static_cast<size_t>(N)*N;
+
+  ThreadPool::get().run(nthrds, [&](int id) {
+    std::fill(rho.begin() + plane*pmSlab[id],
+	      rho.begin() + plane*pmSlab[id+1], 0.0);
+
+    int ix[3], iy[3], iz[3];
+    double wx[3], wy[3], wz[3];
+
+    for (int t=0; t<nthrds; t++) {
+      for (auto & p : pmBin[t][id]) {
+
+	pm_weights(p[0], ix, wx);
+	pm_weights(p[1], iy, wy);
+	pm_weights(p[2], iz, wz);
+
+	for (int a=0; a<pmOrder; a++) {
+	  if (pmOwner[ix[a]] != id) continue;
+	  for (int b=0; b<pmOrder; b++) {
+	    double wab = p[3]*wx[a]*wy[b];
+	    for (int c=0; c<pmOrder; c++)
+	      rho[pm_node(ix[a], iy[b], iz[c])] += wab*wz[c];
+	  }
+	}
+      }
+    }
+  });
+
+  // Sum across processes on the root, which does the single forward
+  // transform.  The other processes contribute nothing to expcoef
+  // here; the caller's MPI_Allreduce of the coefficients distributes
+  // the result.
+  //
+  if (myid==0)
+    MPI_Reduce(MPI_IN_PLACE, rho.data(), rho.size(), MPI_DOUBLE, MPI_SUM,
+	       0, MPI_COMM_WORLD);
+  else
+    MPI_Reduce(rho.data(), nullptr, rho.size(), MPI_DOUBLE, MPI_SUM,
+	       0, MPI_COMM_WORLD);
+
+  if (myid) return;
+
+  // Forward transform: the mesh node i sits at x=i/N so that
+  // F(k) = sum_p m_p exp(-2 pi i k.x_p) W(k)
+  //
+  std::vector<std::complex<double>> F(static_cast<size_t>(N)*N*Nh);
+
+  fftw_plan plan = fftw_plan_dft_r2c_3d
+    (N, N, N, rho.data(), reinterpret_cast<fftw_complex*>(F.data()),
+     FFTW_ESTIMATE);
+  fftw_execute(plan);
+  fftw_destroy_plan(plan);
+
+  // The r2c transform holds kz>=0; the other half follows from
+  // F(-k) = conj(F(k))
+  //
+  auto wrap = [N](int k) { return k<0 ? k+N : k; };
+
+  for (int ix=0; ix<imx; ix++) {
+    for (int iy=0; iy<imy; iy++) {
+      for (int iz=0; iz<imz; iz++) {
+
+	int ii = ix-nmaxx;
+	int jj = iy-nmaxy;
+	int kk = iz-nmaxz;
+	    
+	if (ii==0 and jj==0 and kk==0) continue;
+
+	std::complex<double> f;
+	if (kk>=0)
+	  f = F[(static_cast<size_t>(wrap(ii))*N + wrap(jj))*Nh + kk];
+	else
+	  f = std::conj(F[(static_cast<size_t>(wrap(-ii))*N + wrap(-jj))*Nh - kk]);
+
+	double W = pm_window(ii)*pm_window(jj)*pm_window(kk);
+
+	// Normalization
+	double norm = 1.0/sqrt(M_PI*(ii*ii + jj*jj + kk*kk));
+
+	expcoef[0](ix, iy, iz) += - f * norm / W;
+      }
+    }
+  }
+#endif
+}
+
+void Cube::pm_fields()
+{
+#ifdef HAVE_FFTW
+  int N = pmesh, Nh = pmesh/2 + 1;
+  size_t msize = static_cast<size_t>(N)*N*N;
+
+  pmPot.resize(msize);
+  for (auto & v : pmAcc) v.resize(msize);
+
+  // Half spectra for the potential and the three acceleration
+  // components.  The interpolation back to the particles smooths by
+  // the window once more, so it is deconvolved here.
+  //
+  std::vector<std::complex<double>> H[4];
+  for (auto & v : H) v.assign(static_cast<size_t>(N)*N*Nh, 0.0);
+
+  auto wrap = [N](int k) { return k<0 ? k+N : k; };
+
+  for (int ix=0; ix<imx; ix++) {
+    for (int iy=0; iy<imy; iy++) {
+      for (int iz=nmaxz; iz<imz; iz++) {
+
+	int ii = ix-nmaxx;
+	int jj = iy-nmaxy;
+	int kk = iz-nmaxz;
+
+	// No contribution to acceleration and potential ("swindle")
+	// for zero wavenumber
+	if (ii==0 && jj==0 && kk==0) continue;
+	  
+	// Limit to minimum wave number
+	if (abs(ii)<nminx || abs(jj)<nminy || abs(kk)<nminz) continue;
+	  
+	// Normalization
+	double norm = 1.0/sqrt(M_PI*(ii*ii + jj*jj + kk*kk));
+	double W    = pm_window(ii)*pm_window(jj)*pm_window(kk);
+
+	std::complex<double> C = expcoef[0](ix, iy, iz)*norm/W;
+
+	size_t n = (static_cast<size_t>(wrap(ii))*N + wrap(jj))*Nh + kk;
+
+	H[0][n] =  C;
+	H[1][n] = -std::complex<double>(0.0, dfac*ii)*C;
+	H[2][n] = -std::complex<double>(0.0, dfac*jj)*C;
+	H[3][n] = -std::complex<double>(0.0, dfac*kk)*C;
+      }
+    }
+  }
+
+  // Inverse transforms: sum_k H(k) exp(2 pi i k.x) on the mesh.  The
+  // coefficients are already summed over processes, so each process
+  // makes its own meshes without communication.
+  //
+  double* out[4] = {pmPot.data(), pmAcc[0].data(), pmAcc[1].data(), pmAcc[2].data()};
+
+  for (int j=0; j<4; j++) {
+    fftw_plan plan = fftw_plan_dft_c2r_3d
+      (N, N, N, reinterpret_cast<fftw_complex*>(H[j].data()), out[j],
+       FFTW_ESTIMATE);
+    fftw_execute(plan);
+    fftw_destroy_plan(plan);
+  }
+#endif
+}
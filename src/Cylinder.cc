@@ -90,6 +90,7 @@ Cylinder::valid_keys = {
   "expcond",
   "precond",
   "logr",
+  "packtables",
   "pcavar",
   "pcaeof",
   "pcavtk",
@@ -163,6 +164,7 @@ Cylinder::Cylinder(Component* c0, const YAML::Node& conf, MixtureBasis *m) :
   cmapR           = 1;
   cmapZ           = 1;
   logarithmic     = false;
+  packtables      = false;
   pcavar          = false;
   pcavtk          = false;
   pcadiag         = false;
@@ -199,6 +201,7 @@ Cylinder::Cylinder(Component* c0, const YAML::Node& conf, MixtureBasis *m) :
   EmpCylSL::CMAPR       = cmapR;
   EmpCylSL::CMAPZ       = cmapZ;
   EmpCylSL::logarithmic = logarithmic;
+  EmpCylSL::packed_tables = packtables;
   EmpCylSL::VFLAG       = vflag;
 
   if (cachename.size()==0)
@@ -437,6 +440,7 @@ void Cylinder::initialize()
     if (conf["expcond"   ])    precond  = conf["expcond"   ].as<bool>();
     if (conf["precond"   ])    precond  = conf["precond"   ].as<bool>();
     if (conf["logr"      ]) logarithmic = conf["logr"      ].as<bool>();
+    if (conf["packtables"])  packtables = conf["packtables"].as<bool>();
     if (conf["pcavar"    ])     pcavar  = conf["pcavar"    ].as<bool>();
     if (conf["pcaeof"    ])     pcaeof  = conf["pcaeof"    ].as<bool>();
     if (conf["pcavtk"    ])     pcavtk  = conf["pcavtk"    ].as<bool>();
@@ -755,16 +759,31 @@ void * Cylinder::determine_coefficients_thread(void * arg)
 
     double adb = component->Adiabatic();
 
+				// Use the slot mirror if packed
+    bool soa = cC->SoA(mlevel);
+    unsigned sbeg = soa ? cC->SoABeg(mlevel) : 0;
+
     for (int i=nbeg; i<nend; i++) {
 
-      indx = cC->levlist[mlevel][i];
+      if (soa) {
+	unsigned s = sbeg + i;
 
-      // Frozen particles don't contribute to field
-      //
-      if (cC->freeze(indx)) continue;
+	// Frozen particles don't contribute to field
+	//
+	if (cC->SoAFreeze(s)) continue;
+
+	indx = cC->SoAIndex(s);
+	cC->SoAPos(pos[id].data(), s, Component::Local | Component::Centered);
+      } else {
+	indx = cC->levlist[mlevel][i];
+
+	// Frozen particles don't contribute to field
+	//
+	if (cC->freeze(indx)) continue;
     
-      for (int j=0; j<3; j++) 
-	pos[id][j] = cC->Pos(indx, j, Component::Local | Component::Centered);
+	for (int j=0; j<3; j++) 
+	  pos[id][j] = cC->Pos(indx, j, Component::Local | Component::Centered);
+      }
 
       if ( (cC->EJ & Orient::AXIS) && !cC->EJdryrun) 
 	pos[id] = cC->orient->transformBody() * pos[id];
@@ -779,7 +798,7 @@ void * Cylinder::determine_coefficients_thread(void * arg)
     
       if ( R2 < Rmax2) {
 
-	mas = cC->Mass(indx) * adb;
+	mas = (soa ? cC->SoAMass(sbeg + i) : cC->Mass(indx)) * adb;
 	phi = atan2(yy, xx);
 
 	ortho->accumulate(r, zz, phi, mas, indx, id, mlevel, compute);
@@ -1198,20 +1217,33 @@ void * Cylinder::determine_acceleration_and_potential_thread(void * arg)
 
     if (nbodies==0) continue;
 
-    int nbeg = nbodies*id/nthrds;
-    int nend = nbodies*(id+1)/nthrds;
-    
+				// Use the slot mirror if packed
+    bool soa = cC->SoA(lev);
+    unsigned sbeg = soa ? cC->SoABeg(lev) : 0;
+
+    // Chunks of this level: this thread's slice first, then chunks
+    // stolen from the other threads' slices
+    //
+    int nend = 0;
+
 #ifdef DEBUG
     cout << "Process " << myid << " id=" << id 
 	 << ": nbodies=" << nbodies
-	 << " lev=" << lev
-	 << " nbeg=" << nbeg
-	 << " nend=" << nend << endl;
+	 << " lev=" << lev << endl;
 #endif
 
-    for (int q=nbeg; q<nend; q++) {
+    for (int q=0; ; q++) {
+
+      if (q>=nend and not work[lev].next(id, q, nend)) break;
 
-      unsigned indx = cC->levlist[lev][q];
+      unsigned s    = sbeg + q;
+      unsigned indx = soa ? cC->SoAIndex(s) : cC->levlist[lev][q];
+
+      auto pos_at = [&](double* ps, unsigned flags)
+      {
+	if (soa) cC->SoAPos(ps, s, flags);
+	else     cC->Pos   (ps, indx, flags);
+      };
 
       // Deep debug
       /*
@@ -1225,10 +1257,10 @@ void * Cylinder::determine_acceleration_and_potential_thread(void * arg)
       if (mix) {
 
 	if (use_external) {
-	  cC->Pos(pos[id].data(), indx, Component::Inertial);
+	  pos_at(pos[id].data(), Component::Inertial);
 	  component->ConvertPos(pos[id].data(), Component::Local);
 	} else
-	  cC->Pos(pos[id].data(), indx, Component::Local);
+	  pos_at(pos[id].data(), Component::Local);
 
 	// Only apply this fraction of the force
 	mfactor = mix->Mixture(pos[id].data());
@@ -1237,10 +1269,10 @@ void * Cylinder::determine_acceleration_and_potential_thread(void * arg)
       } else {
 
 	if (use_external) {
-	  cC->Pos(pos[id].data(), indx, Component::Inertial);
+	  pos_at(pos[id].data(), Component::Inertial);
 	  component->ConvertPos(pos[id].data(), Component::Local | Component::Centered);
 	} else
-	  cC->Pos(pos[id].data(), indx, Component::Local | Component::Centered);
+	  pos_at(pos[id].data(), Component::Local | Component::Centered);
 
       }
 
@@ -1308,12 +1340,16 @@ void * Cylinder::determine_acceleration_and_potential_thread(void * arg)
 #endif
       }
     
-      cC->AddPot(indx, pa);
-
       if ( (component->EJ & Orient::AXIS) && !component->EJdryrun) 
 	frc[id] = component->orient->transformOrig() * frc[id];
 
-      for (int j=0; j<3; j++) cC->AddAcc(indx, j, frc[id][j]);
+      if (soa) {
+	cC->SoAAddPot(s, pa);
+	for (int j=0; j<3; j++) cC->SoAAddAcc(s, j, frc[id][j]);
+      } else {
+	cC->AddPot(indx, pa);
+	for (int j=0; j<3; j++) cC->AddAcc(indx, j, frc[id][j]);
+      }
 
 #ifdef DEBUG
       if (firstime && myid==0 && id==0 && q < 5) {
@@ -1568,6 +1604,7 @@ void Cylinder::dump_coefs_h5(const std::string& file)
     // Add the new coefficients and write the new HDF5
     cylCoefs.clear();
     cylCoefs.add(cur);
+    cylCoefs.setH5Layout(h5series, h5chunk, h5deflate, h5shuffle);
     cylCoefs.WriteH5Coefs(file);
   }
 }
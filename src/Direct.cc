@@ -18,7 +18,9 @@ Direct::valid_keys = {
   "pm_model",
   "diverge",
   "diverge_rfac",
-  "pmmodel_file"
+  "pmmodel_file",
+  "tileSize",
+  "ringTiming"
 };
 
 Direct::Direct(Component* c0, const YAML::Node& conf) : PotAccel(c0, conf)
@@ -43,6 +45,15 @@ Direct::Direct(Component* c0, const YAML::Node& conf) : PotAccel(c0, conf)
   diverge      = 0;	            // Use analytic divergence (true/false)
   diverge_rfac = 1.0;               // Exponent for profile divergence
 
+  // Bodies per block in the pairwise summation
+  //
+  tileSize     = 256;
+
+  // Ring stage timing report interval
+  //
+  ringTiming   = 0;
+  ringCalls    = 0;
+
   initialize();
 
   if (pm_model) pmmodel = new SphericalModelTable(pmmodel_file, diverge, diverge_rfac);
@@ -54,6 +65,7 @@ Direct::Direct(Component* c0, const YAML::Node& conf) : PotAccel(c0, conf)
 				// Buffer pointers
   tmp_buffer = NULL;
   bod_buffer = NULL;
+  buffer_alloc = 0;
 }
 
 Direct::~Direct()
@@ -100,6 +112,8 @@ void Direct::initialize(void)
     if (conf["diverge"])          diverge      = conf["diverge"].as<int>();
     if (conf["diverge_rfac"])     diverge_rfac = conf["diverge_rfac"].as<double>();
     if (conf["pmmodel_file"])     pmmodel_file = conf["pmmodel_file"].as<std::string>();
+    if (conf["tileSize"])         tileSize     = conf["tileSize"].as<int>();
+    if (conf["ringTiming"])       ringTiming   = conf["ringTiming"].as<int>();
   }
   catch (YAML::Exception & error) {
     if (myid==0) std::cout << "Error parsing parameters in Direct: "
@@ -112,6 +126,7 @@ void Direct::initialize(void)
     throw std::runtime_error("Direct::initialize: error parsing YAML");
   }
 
+  if (tileSize<1) tileSize = 1;
 }
 
 void Direct::get_acceleration_and_potential(Component* C)
@@ -153,12 +168,16 @@ void Direct::determine_acceleration_and_potential(void)
 #endif
   
 				// Allocate buffers to handle largest list
-  delete [] tmp_buffer;
-  delete [] bod_buffer;
-
   int buffer_size = max_bodies*ndim;
-  tmp_buffer = new double [buffer_size];
-  bod_buffer = new double [buffer_size];
+
+  if (buffer_size > buffer_alloc) {
+    delete [] tmp_buffer;
+    delete [] bod_buffer;
+
+    tmp_buffer = new double [buffer_size];
+    bod_buffer = new double [buffer_size];
+    buffer_alloc = buffer_size;
+  }
   
   // Load body buffer with local interactors
   double *p = bod_buffer;
@@ -174,45 +193,90 @@ void Direct::determine_acceleration_and_potential(void)
     if (!fixed_soft) *(p++) = component->Part(i)->dattrib[soft_indx];
   }
 
-				// Do the local interactors
-  exp_thread_fork(false);
+				// Per-thread block workspace
+  tileWork.resize(nthrds);
+  for (auto & v : tileWork) v.resize(7*tileSize);
 
-				// Do the ring . . . 
-  for (int n=1; n<numprocs; n++) {
-      
-    MPI_Request req1, req2;
-    MPI_Status stat;
-    
-				// Copy current to temp buffer
-    memcpy(tmp_buffer, bod_buffer, buffer_size*sizeof(double));
+  if (ringTiming) {
+    stageComp.resize(numprocs, 0.0);
+    stageWait.resize(numprocs, 0.0);
+  }
 
-				// Get NEW buffer from right
-    MPI_Irecv(bod_buffer, buffer_size, MPI_DOUBLE, from_proc, MSGTAG, 
-	      MPI_COMM_WORLD, &req1);
+  // Do the ring: the bodies for the next stage are received into the
+  // spare buffer while the current bodies are sent on and their
+  // interactions are accumulated.  Stage 0 is the local interactors.
+  //
+  for (int n=0; n<numprocs; n++) {
 
-				// Send OLD buffer to left
-    MPI_Isend(tmp_buffer, ninteract*ndim, MPI_DOUBLE, to_proc, MSGTAG, 
-	      MPI_COMM_WORLD, &req2);
+    MPI_Request req[2];
+    MPI_Status  stat[2];
 
-    MPI_Wait(&req2, &stat);
-    MPI_Wait(&req1, &stat);
+    bool more = n+1 < numprocs;
+
+    if (more) {
+				// Get NEW buffer from right
+      MPI_Irecv(tmp_buffer, buffer_size, MPI_DOUBLE, from_proc, MSGTAG, 
+		MPI_COMM_WORLD, &req[0]);
+
+				// Send CURRENT buffer to left
+      MPI_Isend(bod_buffer, ninteract*ndim, MPI_DOUBLE, to_proc, MSGTAG, 
+		MPI_COMM_WORLD, &req[1]);
+    }
 
-				// How many particles did we get?
-    MPI_Get_count(&stat, MPI_DOUBLE, &ninteract);
-    ninteract /= ndim;
-	
 				// Accumulate the interactions
+    timer_comp.reset();
+    timer_comp.start();
+
+    unpack_buffer();
     exp_thread_fork(false);
 
+    timer_comp.stop();
+
+    if (more) {
+				// Exposed communication time
+      timer_wait.reset();
+      timer_wait.start();
+
+      MPI_Waitall(2, req, stat);
+
+      timer_wait.stop();
+
+				// How many particles did we get?
+      MPI_Get_count(&stat[0], MPI_DOUBLE, &ninteract);
+      ninteract /= ndim;
+
+				// The received buffer is now current
+      std::swap(tmp_buffer, bod_buffer);
+    }
+
+    if (ringTiming) {
+      stageComp[n] += timer_comp.getTime();
+      stageWait[n] += more ? timer_wait.getTime() : 0.0;
+    }
   }
+
+  if (ringTiming and ++ringCalls % ringTiming == 0) ring_timing_report();
+
 				// Clear external potential flag
   use_external = false;
 }
 
-void * Direct::determine_acceleration_and_potential_thread(void * arg)
+void Direct::unpack_buffer()
 {
-  double pos[3], eps = soft;
+  jmass.resize(ninteract);
+  for (auto & v : jpos) v.resize(ninteract);
+  jeps.resize(ninteract);
 
+  double *p = bod_buffer;
+  for (int n=0; n<ninteract; n++) {
+    jmass[n] = *(p++);
+    for (int k=0; k<3; k++) jpos[k][n] = *(p++);
+    jeps[n] = fixed_soft ? soft : *(p++);
+  }
+}
+
+void * Direct::determine_acceleration_and_potential_thread(void * arg)
+{
   int id = *((int*)arg);
 
 #ifdef DEBUG
@@ -221,6 +285,36 @@ void * Direct::determine_acceleration_and_potential_thread(void * arg)
   unsigned ncnt=0;
 #endif
 
+  // Block workspace
+  //
+  double *R  = &tileWork[id][0];
+  double *E  = R + tileSize;
+  double *M  = E + tileSize;
+  double *P  = M + tileSize;
+  double *DX = P + tileSize;
+  double *DY = DX + tileSize;
+  double *DZ = DY + tileSize;
+
+  // Extended point-mass model normalization
+  //
+  double pmrmax = 0.0, pmmass = 1.0;
+  if (pm_model) {
+    pmrmax = pmmodel->get_max_radius();
+    pmmass = pmmodel->get_mass(pmrmax);
+  }
+
+  double adb = component->Adiabatic();
+
+  // Use the slot mirror if packed
+  //
+  bool soa = cC->SoA(mlevel);
+
+  // Tile of local particles: positions and accumulated acceleration
+  // and potential
+  //
+  double xi[tileI][3], ai[tileI][3], pi[tileI];
+  unsigned long ni[tileI];
+
   // If we are multistepping, compute accel only at or above <mlevel>
   //
   for (int lev=mlevel; lev<=multistep; lev++) {
@@ -229,118 +323,153 @@ void * Direct::determine_acceleration_and_potential_thread(void * arg)
     int nbeg = nbodies*id/nthrds;
     int nend = nbodies*(id+1)/nthrds;
 
-    double adb = component->Adiabatic();
+    unsigned sbeg = soa ? cC->SoABeg(lev) : 0;
 
-    for (int i=nbeg; i<nend; i++) {
-    
-				// Index of the current local particle
-      unsigned long j = cC->levlist[lev][i];
+    int i = nbeg;
 
+    while (i<nend) {
+
+      // Load the next tile of active local particles
+      //
+      int nt = 0;
+      for (; i<nend and nt<tileI; i++) {
+	if (soa) {
+	  unsigned s = sbeg + i;
 				// Don't need acceleration for frozen particles
-      if (cC->freeze(j)) continue;
-    
-				// Loop through the particle list
-      double * p = bod_buffer;
-      for (int n=0; n<ninteract; n++) {
-
-				// Get current interaction particle
-				// mass from ring buffer
-	double mass = *(p++) * adb;
-				// Position
-	for (int k=0; k<3; k++) pos[k] = *(p++);
-	
-	// Compute interparticle squared distance
-	//
-	double rr0 = 0.0;
-	for (int k=0; k<3; k++) rr0 +=
-				  (cC->Pos(j, k) - pos[k]) *
-				  (cC->Pos(j, k) - pos[k]) ;
-	double rr = sqrt(rr0);
-	
-	// Reject particle at current location
-	//
-	if (rr>rtol) {
-	  
+	  if (cC->SoAFreeze(s)) continue;
+	  cC->SoAPos(xi[nt], s);
+	  ni[nt] = s;
+	} else {
+	  unsigned long j = cC->levlist[lev][i];
+				// Don't need acceleration for frozen particles
+	  if (cC->freeze(j)) continue;
+	  cC->Pos(xi[nt], j);
+	  ni[nt] = j;
+	}
+	for (int k=0; k<3; k++) ai[nt][k] = 0.0;
+	pi[nt] = 0.0;
+	nt++;
+      }
+
+      // Loop through the ring buffer by blocks
+      //
+      for (int j0=0; j0<ninteract; j0+=tileSize) {
+
+	int nb = std::min<int>(tileSize, ninteract - j0);
+
+	const double *mj = &jmass[j0];
+	const double *xj = &jpos[0][j0];
+	const double *yj = &jpos[1][j0];
+	const double *zj = &jpos[2][j0];
+
+	for (int t=0; t<nt; t++) {
+
+	  double ax = 0.0, ay = 0.0, az = 0.0, pot = 0.0;
+
+	  // Interparticle separations
+	  //
+	  for (int n=0; n<nb; n++) {
+	    DX[n] = xi[t][0] - xj[n];
+	    DY[n] = xi[t][1] - yj[n];
+	    DZ[n] = xi[t][2] - zj[n];
+	    R [n] = sqrt(DX[n]*DX[n] + DY[n]*DY[n] + DZ[n]*DZ[n]);
+	  }
+
 	  // BEG: Miyamoto-Nagai (MN) disk-shaped point mass
-	  if (mn_model) {	
+	  if (mn_model) {
 
-	    // Positions relative to point mass center
-	    //
-	    double xx = cC->Pos(j, 0) - pos[0];
-	    double yy = cC->Pos(j, 1) - pos[1];
-	    double zz = cC->Pos(j, 2) - pos[2];
+	    for (int n=0; n<nb; n++) {
 
-	    // MN intermediate computation
-	    //
-	    double rr = sqrt( xx*xx + yy*yy );
-	    double zb = sqrt( zz*zz + b * b );
-	    double ab = a + zb;
-	    double dn = sqrt( rr*rr + ab*ab );
+	      // Reject particle at current location
+	      //
+	      if (R[n]<=rtol) continue;
+
+	      double mass = mj[n] * adb;
+
+	      // MN intermediate computation
+	      //
+	      double rr = sqrt( DX[n]*DX[n] + DY[n]*DY[n] );
+	      double zb = sqrt( DZ[n]*DZ[n] + b * b );
+	      double ab = a + zb;
+	      double dn = sqrt( rr*rr + ab*ab );
 	    
-	    // MN potential and cylindrical force
-	    //
-	    double pot = -mass/dn;
-	    double fr  = -mass*rr/(dn*dn*dn);
-	    double fz  = -mass*zz*ab/(zb*dn*dn*dn);
+	      // MN potential and cylindrical force
+	      //
+	      double fr  = -mass*rr/(dn*dn*dn);
+	      double fz  = -mass*DZ[n]*ab/(zb*dn*dn*dn);
 	  
-	    // Add acceleration by disk particle
-	    //
-	    cC->AddAcc(j, 0, fr*xx/(rr+1.0e-10) );
-	    cC->AddAcc(j, 1, fr*yy/(rr+1.0e-10) );
-	    cC->AddAcc(j, 2, fz );
-	  
-#ifdef DEBUG
-	    if (use_external) {
-	      ncnt++;
-	      tclausius[id] += mass * ( (fr*xx + fr*yy)/(rr+1.0e-10) + fz);
+	      ax  += fr*DX[n]/(rr+1.0e-10);
+	      ay  += fr*DY[n]/(rr+1.0e-10);
+	      az  += fz;
+	      pot += -mass/dn;
 	    }
-#endif
-	    // Particle potential
-	    cC->AddPot(j, pot );
-
 	  }
 	  // END: Miyamoto-Nagai point mass
 	  // BEG: Spherical point mass
 	  else {
-	  
-	    if (!fixed_soft) eps = *(p++);
+
+	    // Softened mass fractions and potentials for the block
+	    //
+	    if (fixed_soft) std::fill(E, E+nb, soft);
+	    else            std::copy(jeps.begin()+j0, jeps.begin()+j0+nb, E);
+
+	    kernel->batch(nb, R, E, M, P);
+
+	    for (int n=0; n<nb; n++) P[n] *= mj[n] * adb;
 
 				// Extended model for point masses
                                 // Given model provides normalized mass distrbution
-	    double pot = 0.0;
-	  
-	    if (pm_model && pmmodel->get_max_radius() > rr) {
-	      double mass_frac =
-		pmmodel->get_mass(rr) / pmmodel->get_mass(pmmodel->get_max_radius());
-	      pot = pmmodel->get_pot(rr)/pmmodel->get_mass(pmmodel->get_max_radius());
-	      mass *= mass_frac;
-	    } else {
-	      auto y = (*kernel)(rr, eps);
-	      pot = mass * y.second;
-	      mass *= y.first;
+	    if (pm_model) {
+	      for (int n=0; n<nb; n++) {
+		if (pmrmax > R[n]) {
+		  M[n] = pmmodel->get_mass(R[n]) / pmmass;
+		  P[n] = pmmodel->get_pot(R[n]) / pmmass;
+		}
+	      }
 	    }
-	    
-	    // Acceleration
-	    double rfac = 1.0/(rr*rr*rr);
-	    
-	    for (int k=0; k<3; k++)
-	      cC->AddAcc(j, k, -mass *(cC->Pos(j, k) - pos[k]) * rfac );
-	    
-	    // Potential
-#ifdef DEBUG
-	    if (use_external) {
-	      ncnt++;
-	      for (int k=0; k<3; k++)
-		tclausius[id] += -mass *
-		  (cC->Pos(j, k) - pos[k]) * cC->Pos(j, k) * rfac;
+
+	    // Accumulate; particles at the current location are rejected
+	    //
+	    for (int n=0; n<nb; n++) {
+	      bool ok = R[n]>rtol;
+	      double w = ok ? mj[n]*adb*M[n]/(R[n]*R[n]*R[n]) : 0.0;
+	      ax  -= w*DX[n];
+	      ay  -= w*DY[n];
+	      az  -= w*DZ[n];
+	      pot += ok ? P[n] : 0.0;
 	    }
-#endif
-	    cC->AddPot(j, pot );
 	  }
+	  // END: spherical point mass
+
+	  ai[t][0] += ax;
+	  ai[t][1] += ay;
+	  ai[t][2] += az;
+	  pi[t]    += pot;
+
+#ifdef DEBUG
+	  if (use_external) ncnt += nb;
+#endif
 	}
-	// END: spherical point mass
+	// END: local tile
+      }
+      // END: buffer block loop
+
+      // Add the tile accelerations and potentials to the particles
+      //
+      for (int t=0; t<nt; t++) {
+	if (soa) {
+	  for (int k=0; k<3; k++) cC->SoAAddAcc(ni[t], k, ai[t][k]);
+	  cC->SoAAddPot(ni[t], pi[t]);
+	} else {
+	  cC->AddAcc(ni[t], ai[t]);
+	  cC->AddPot(ni[t], pi[t]);
+	}
+#ifdef DEBUG
+	if (use_external) {
+	  for (int k=0; k<3; k++) tclausius[id] += ai[t][k]*xi[t][k];
+	}
+#endif
       }
-      // END: buffer interaction loop
     }
     // END: local particle loop
   }
@@ -358,6 +487,44 @@ void * Direct::determine_acceleration_and_potential_thread(void * arg)
   return (NULL);
 }
 
+void Direct::ring_timing_report()
+{
+  std::vector<double> comp(numprocs), wait(numprocs);
+
+  MPI_Reduce(stageComp.data(), comp.data(), numprocs, MPI_DOUBLE, MPI_MAX,
+	     0, MPI_COMM_WORLD);
+  MPI_Reduce(stageWait.data(), wait.data(), numprocs, MPI_DOUBLE, MPI_MAX,
+	     0, MPI_COMM_WORLD);
+
+  if (myid==0) {
+    double tcomp = 0.0, twait = 0.0;
+
+    std::cout << std::string(60, '-') << std::endl
+	      << "Direct <" << component->name << ">: ring stage times (s)"
+	      << " for " << ringTiming << " calls, max over processes"
+	      << std::endl << std::string(60, '-') << std::endl
+	      << std::setw(8)  << std::right << "Stage"
+	      << std::setw(18) << "Compute"
+	      << std::setw(18) << "Exposed comm" << std::endl;
+
+    for (int n=0; n<numprocs; n++) {
+      std::cout << std::setw(8)  << n
+		<< std::setw(18) << comp[n]
+		<< std::setw(18) << wait[n] << std::endl;
+      tcomp += comp[n];
+      twait += wait[n];
+    }
+
+    std::cout << std::setw(8)  << "Total"
+	      << std::setw(18) << tcomp
+	      << std::setw(18) << twait << std::endl
+	      << std::string(60, '-') << std::endl;
+  }
+
+  std::fill(stageComp.begin(), stageComp.end(), 0.0);
+  std::fill(stageWait.begin(), stageWait.end(), 0.0);
+}
+
 void Direct::determine_coefficients(void) {}
 void * Direct::determine_coefficients_thread(void *arg) { return (NULL); }
 
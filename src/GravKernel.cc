@@ -29,3 +29,45 @@ std::pair<double, double> SplineSoft::operator()(double r, double eps)
 
   return ret;
 }
+
+void SoftKernel::batch(int n, const double* r, const double* eps,
+		       double* mfrac, double* pot)
+{
+  for (int i=0; i<n; i++) {
+    auto y = (*this)(r[i], eps[i]);
+    mfrac[i] = y.first;
+    pot[i]   = y.second;
+  }
+}
+
+void PlummerSoft::batch(int n, const double* r, const double* eps,
+			double* mfrac, double* pot)
+{
+  // The two potential terms of the scalar operator sum to
+  // -1/sqrt(r^2 + eps^2)
+  //
+  for (int i=0; i<n; i++) {
+    double is = 1.0/std::sqrt(r[i]*r[i] + eps[i]*eps[i]);
+    mfrac[i] = r[i]*r[i]*r[i]*is*is*is;
+    pot[i]   = -is;
+  }
+}
+
+void SplineSoft::batch(int n, const double* r, const double* eps,
+		       double* mfrac, double* pot)
+{
+  for (int i=0; i<n; i++) {
+    double x = r[i]/eps[i];
+    if (x<0.5) {
+      mfrac[i] = m1(x);
+      pot[i]   = -(fac1 - p1(x))/eps[i];
+      if (x>tol) pot[i] += -mfrac[i]/r[i];
+    } else if (x<1.0) {
+      mfrac[i] = fac0 + m2(x);
+      pot[i]   = -mfrac[i]/r[i] - (fac2 - p2(x))/eps[i];
+    } else {
+      mfrac[i] = 1.0;
+      pot[i]   = -1.0/r[i];
+    }
+  }
+}
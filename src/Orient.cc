@@ -740,3 +740,90 @@ void Orient::logEntry(double time, Component *c)
 Orient::~Orient()
 {
 }
+
+void Orient::pack(std::vector<double>& buf)
+{
+  auto put3 = [&buf](const Eigen::Vector3d& v)
+  { for (int k=0; k<3; k++) buf.push_back(v[k]); };
+
+  auto putQ = [&buf](const deque<DV>& q)
+  {
+    buf.push_back(q.size());
+    for (auto & v : q) {
+      buf.push_back(v.first);
+      for (int k=0; k<3; k++) buf.push_back(v.second[k]);
+    }
+  };
+
+  buf.push_back(Ecurr);
+  buf.push_back(Elast);
+  buf.push_back(Nlast);
+  buf.push_back(used);
+  buf.push_back(lasttime);
+  buf.push_back(sigA);
+  buf.push_back(sigC);
+  buf.push_back(sigCz);
+
+  put3(axis);
+  put3(axis1);
+  put3(center);
+  put3(center1);
+  put3(center0);
+  put3(cenvel0);
+
+  for (int j=0; j<3; j++)
+    for (int k=0; k<3; k++) buf.push_back(body(j, k));
+
+  for (int j=0; j<3; j++)
+    for (int k=0; k<3; k++) buf.push_back(orig(j, k));
+
+  putQ(sumsA);
+  putQ(sumsC);
+}
+
+size_t Orient::unpack(const double* buf)
+{
+  const double* p = buf;
+
+  auto get3 = [&p](Eigen::Vector3d& v)
+  { for (int k=0; k<3; k++) v[k] = *p++; };
+
+  auto getQ = [&p](deque<DV>& q)
+  {
+    q.clear();
+    size_t n = static_cast<size_t>(*p++);
+    for (size_t i=0; i<n; i++) {
+      double t = *p++;
+      Eigen::VectorXd v(3);
+      for (int k=0; k<3; k++) v[k] = *p++;
+      q.push_back(DV(t, v));
+    }
+  };
+
+  Ecurr    = *p++;
+  Elast    = *p++;
+  Nlast    = static_cast<int>(*p++);
+  used     = static_cast<int>(*p++);
+  lasttime = *p++;
+  sigA     = *p++;
+  sigC     = *p++;
+  sigCz    = *p++;
+
+  get3(axis);
+  get3(axis1);
+  get3(center);
+  get3(center1);
+  get3(center0);
+  get3(cenvel0);
+
+  for (int j=0; j<3; j++)
+    for (int k=0; k<3; k++) body(j, k) = *p++;
+
+  for (int j=0; j<3; j++)
+    for (int k=0; k<3; k++) orig(j, k) = *p++;
+
+  getQ(sumsA);
+  getQ(sumsC);
+
+  return p - buf;
+}
@@ -12,6 +12,7 @@
 
 #include <AxisymmetricBasis.H>
 #include <OutCHKPT.H>
+#include <AsyncWriter.H>
 
 const std::set<std::string>
 OutCHKPT::valid_keys = {
@@ -20,10 +21,12 @@ OutCHKPT::valid_keys = {
   "nint",
   "nintsub",
   "timer",
-  "nagg"
+  "nagg",
+  "incremental",
+  "nbase"
 };
 
-OutCHKPT::OutCHKPT(const YAML::Node& conf) : Output(conf)
+OutCHKPT::OutCHKPT(const YAML::Node& conf) : Output(conf), ndelta(0)
 {
   initialize();
 }
@@ -76,6 +79,16 @@ void OutCHKPT::initialize()
       nagg = Output::conf["nagg"].as<std::string>();
     else
       nagg = "1";
+
+    if (Output::conf["incremental"])
+      incremental = Output::conf["incremental"].as<bool>();
+    else
+      incremental = false;
+
+    if (Output::conf["nbase"])
+      nbase = Output::conf["nbase"].as<int>();
+    else
+      nbase = 10;
   }
   catch (YAML::Exception & error) {
     if (myid==0) std::cout << "Error parsing parameters in OutCHKPT: "
@@ -97,8 +110,61 @@ void OutCHKPT::Run(int n, int mstep, bool last)
     if (multistep>1 and mstep % nintsub !=0) return;
   }
 
+  std::chrono::high_resolution_clock::time_point beg, end;
+  if (timer) beg = std::chrono::high_resolution_clock::now();
+
+  if (incremental and not delta) {
+    // Deltas are matched to the base image by particle index
+    //
+    for (auto c : comp->components) {
+      if (not c->Indexing()) {
+	if (myid==0)
+	  std::cout << "OutCHKPT: component <" << c->name
+		    << "> has not set 'indexing', incremental checkpoints"
+		    << " are disabled" << std::endl;
+	incremental = false;
+      }
+    }
+    if (incremental) delta = std::make_shared<ChkptDelta>(filename);
+  }
+
+  if (incremental and ndelta < nbase-1 and delta->ready()) {
+    delta->write();
+    ndelta++;
+  } else {
+    bool linked = WriteFull();
+    if (incremental) {
+      delta->base();
+      ndelta = 0;
+    }
+    if (linked) return;
+  }
+
+  chktimer.mark();
+
+  // Clear the dump signal to prevent an out of sequence *real* output
+  // of a *double* output exists
+  //
+  dump_signal = 0;
+
+  if (timer) {
+    end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> intvl = end - beg;
+    if (myid==0)
+      std::cout << "OutCHKPT [T=" << tnow << "] timing=" << intvl.count()
+		<< std::endl;
+  }
+}
+
+
+bool OutCHKPT::WriteFull()
+{
   int returnStatus = 1;
 
+  // Collect an async dump for this time so that it may be linked
+  //
+  if (pendingPS and pendingPST == tnow) pendingPS->wait();
+
   if (myid==0) {
     string backfile = filename + ".bak";
     if (unlink(backfile.c_str())) {
@@ -122,7 +188,14 @@ void OutCHKPT::Run(int n, int mstep, bool last)
       }
     }
     
-    if (lastPS.size()) {
+    bool stale = lastPST != tnow;
+
+    if (lastPS.size() and stale) {
+      if (VERBOSE>5)
+	cout << "OutCHKPT::Run(): last output <" << lastPS << "> at T="
+	     << lastPST << " is not current, writing a new checkpoint" << endl;
+      returnStatus = 0;
+    } else if (lastPS.size()) {
       if (symlink(lastPS.c_str(), filename.c_str())) {
 	if (VERBOSE>5) perror("OutCHKPT::Run()");
 	cout << "OutCHKPT::Run(): no file <" << lastPS
@@ -141,11 +214,8 @@ void OutCHKPT::Run(int n, int mstep, bool last)
   }
 
   MPI_Bcast(&returnStatus, 1, MPI_INT, 0, MPI_COMM_WORLD);
-  if (returnStatus==1) return;
+  if (returnStatus==1) return true;
 
-  std::chrono::high_resolution_clock::time_point beg, end;
-  if (timer) beg = std::chrono::high_resolution_clock::now();
-  
   if (mpio) {
     static bool firsttime = true;
 
@@ -195,7 +265,7 @@ void OutCHKPT::Run(int n, int mstep, bool last)
     if (myid==0) {
       struct MasterHeader header;
       header.time  = tnow;
-      header.ntot  = comp->ntot;
+      header.setTotal(comp->ntot);
       header.ncomp = comp->ncomp;
       
       ret = MPI_File_write_at(file, offset, &header, sizeof(MasterHeader),
@@ -273,7 +343,7 @@ void OutCHKPT::Run(int n, int mstep, bool last)
       if (!nOK) {
 	struct MasterHeader header;
 	header.time  = tnow;
-	header.ntot  = comp->ntot;
+	header.setTotal(comp->ntot);
 	header.ncomp = comp->ncomp;
       
 	out.write((char *)&header, sizeof(MasterHeader));
@@ -311,19 +381,6 @@ void OutCHKPT::Run(int n, int mstep, bool last)
 
   }
 
-  chktimer.mark();
-
-  // Clear the dump signal to prevent an out of sequence *real* output
-  // of a *double* output exists
-  //
-  dump_signal = 0;
-
-  if (timer) {
-    end = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> intvl = end - beg;
-    if (myid==0)
-      std::cout << "OutCHKPT [T=" << tnow << "] timing=" << intvl.count()
-		<< std::endl;
-  }
+  return false;
 }
 
@@ -12,6 +12,7 @@
 
 #include <AxisymmetricBasis.H>
 #include <OutCHKPTQ.H>
+#include <AsyncWriter.H>
 
 
 const std::set<std::string>
@@ -91,6 +92,10 @@ void OutCHKPTQ::Run(int n, int mstep, bool last)
   }
   
   int returnStatus = 1;
+
+  // Collect an async dump for this time so that it may be linked
+  //
+  if (pendingPSQ and pendingPSQT == tnow) pendingPSQ->wait();
   
   if (myid==0) {
     std::string currfile = outdir + filename;
@@ -226,7 +231,7 @@ void OutCHKPTQ::Run(int n, int mstep, bool last)
     if (nOK==0) {
       struct MasterHeader header;
       header.time  = tnow;
-      header.ntot  = comp->ntot;
+      header.setTotal(comp->ntot);
       header.ncomp = comp->ncomp;
 
       out.write((char *)&header, sizeof(MasterHeader));
@@ -12,7 +12,11 @@ OutCoef::valid_keys = {
   "nint",
   "nintsub",
   "native",
-  "name"
+  "name",
+  "series",
+  "chunk",
+  "deflate",
+  "shuffle"
 };
 
 OutCoef::OutCoef(const YAML::Node& conf) : Output(conf)
@@ -20,6 +24,10 @@ OutCoef::OutCoef(const YAML::Node& conf) : Output(conf)
   nint    = 10;
   nintsub = std::numeric_limits<int>::max();
   native  = false;
+  series  = false;
+  shuffle = false;
+  chunk   = 256;
+  deflate = 0;
   tcomp   = NULL;
 
   initialize();
@@ -43,6 +51,10 @@ void OutCoef::initialize()
   try {
     if (conf["nint"])         nint     = conf["nint"].as<int>();
     if (conf["native"])       native   = conf["native"].as<bool>();
+    if (conf["series"])       series   = conf["series"].as<bool>();
+    if (conf["chunk"])        chunk    = conf["chunk"].as<int>();
+    if (conf["deflate"])      deflate  = conf["deflate"].as<int>();
+    if (conf["shuffle"])      shuffle  = conf["shuffle"].as<bool>();
     if (conf["nintsub"]) {
       nintsub  = conf["nintsub"].as<int>();
       if (nintsub <= 0) nintsub = 1;
@@ -71,6 +83,10 @@ void OutCoef::initialize()
 	filename = outdir + "outcoef." + tcomp->name + "." + runtag;
       }
 
+    if (series)
+      tcomp->force->setH5Layout(series, std::max<int>(chunk, 1),
+				deflate, shuffle);
+
   }
   catch (YAML::Exception & error) {
     if (myid==0) std::cout << "Error parsing parameters in OutCoef: "
@@ -105,7 +105,7 @@ void OutPS::Run(int n, int mstep, bool last)
     if (nOK==0) {
       struct MasterHeader header;
       header.time = tnow;
-      header.ntot = comp->ntot;
+      header.setTotal(comp->ntot);
       header.ncomp = comp->ncomp;
       
       out.write((char *)&header, sizeof(MasterHeader));
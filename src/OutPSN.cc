@@ -136,13 +136,16 @@ void OutPSN::Run(int n, int mstep, bool last)
       nOK = 1;
     }
 				// Used by OutCHKPT to not duplicate a dump
-    if (not real4) lastPS = fname.str();
+    if (not real4) {
+      lastPS  = fname.str();
+      lastPST = tnow;
+    }
 
 				// Open file and write master header
     if (nOK==0) {
       struct MasterHeader header;
       header.time  = tnow;
-      header.ntot  = comp->ntot;
+      header.setTotal(comp->ntot);
       header.ncomp = comp->ncomp;
 
       out.write((char *)&header, sizeof(MasterHeader));
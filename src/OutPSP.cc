@@ -3,6 +3,7 @@
 #include <iomanip>
 #include <sstream>
 #include <chrono>
+#include <cstring>
 
 #include "expand.H"
 #include <global.H>
@@ -18,7 +19,9 @@ OutPSP::valid_keys = {
   "nbeg",
   "real4",
   "timer",
-  "nagg"
+  "nagg",
+  "async",
+  "asyncMB"
 };
 
 
@@ -79,6 +82,16 @@ void OutPSP::initialize()
       nagg = Output::conf["nagg"].as<std::string>();
     else
       nagg = "1";
+
+    if (Output::conf["async"])
+      async = Output::conf["async"].as<bool>();
+    else
+      async = false;
+
+    if (Output::conf["asyncMB"])
+      asyncMB = Output::conf["asyncMB"].as<int>();
+    else
+      asyncMB = 1024;
   }
   catch (YAML::Exception & error) {
     if (myid==0) std::cout << "Error parsing parameters in OutPSP: "
@@ -116,6 +129,8 @@ void OutPSP::initialize()
     }
   }
 
+  if (async)
+    writer = std::make_shared<AsyncWriter>(size_t(asyncMB) << 20);
 }
 
 
@@ -144,6 +159,24 @@ void OutPSP::Run(int n, int mstep, bool last)
   ostringstream fname;
   fname << filename << "." << setw(5) << setfill('0') << nbeg++;
 
+  if (async) {
+    RunAsync(fname.str(), last);
+
+    chktimer.mark();
+
+    dump_signal = 0;
+
+    if (timer) {
+      end = std::chrono::high_resolution_clock::now();
+      std::chrono::duration<double> intvl = end - beg;
+      if (myid==0)
+	std::cout << "OutPSP [T=" << tnow << "] staging=" << intvl.count()
+		  << std::endl;
+    }
+
+    return;
+  }
+
   // return info about errors (for debugging)
   MPI_Comm_set_errhandler(MPI_COMM_WORLD, MPI_ERRORS_RETURN); 
 
@@ -168,7 +201,10 @@ void OutPSP::Run(int n, int mstep, bool last)
   MPI_Info_free(&info);
 
 				// Used by OutCHKPT to not duplicate a dump
-  if (!real4) lastPS = fname.str();
+  if (!real4) {
+    lastPS  = fname.str();
+    lastPST = tnow;
+  }
   
     
   // Write master header
@@ -176,7 +212,7 @@ void OutPSP::Run(int n, int mstep, bool last)
   if (myid==0) {
     struct MasterHeader header;
     header.time  = tnow;
-    header.ntot  = comp->ntot;
+    header.setTotal(comp->ntot);
     header.ncomp = comp->ncomp;
     
     ret = MPI_File_write_at(file, offset, &header, sizeof(MasterHeader),
@@ -251,3 +287,84 @@ void OutPSP::Run(int n, int mstep, bool last)
 	      << std::endl;
   }
 }
+
+
+void OutPSP::RunAsync(const std::string& fname, bool last)
+{
+  static bool firsttime = true;
+
+  // Root truncates the shared file; everyone else must wait for that
+  // before any data may land in it
+  //
+  writer->begin();
+  int id = writer->file(fname, myid==0);
+  MPI_Barrier(MPI_COMM_WORLD);
+
+  // lastPS is not set here: the file is incomplete until the
+  // background write finishes so OutCHKPT must not link to it.  It is
+  // set by the completion callback below.
+  //
+  MPI_Offset offset = 0;
+
+  if (myid==0) {
+    struct MasterHeader header;
+    header.time  = tnow;
+    header.setTotal(comp->ntot);
+    header.ncomp = comp->ncomp;
+
+    memcpy(writer->reserve(id, offset, sizeof(MasterHeader)),
+	   &header, sizeof(MasterHeader));
+  }
+  
+  offset += sizeof(MasterHeader);
+
+  for (auto c : comp->components) {
+
+#ifdef HAVE_LIBCUDA
+    if (use_cuda) {
+      if (not comp->fetched[c]) {
+	comp->fetched[c] = true;
+	c->CudaToParticles();
+      }
+    }
+#endif
+
+    if (firsttime and myid==0 and not c->Indexing())
+      std::cout << "OutPSP::run: component <" << c->name
+		<< "> has not set 'indexing' so PSP particle sequence will be lost." << std::endl
+		<< "If this is NOT what you want, set the component flag 'indexing=1'." << std::endl;
+
+    c->stage_binary_mpi(*writer, id, offset, real4);
+  }
+
+  firsttime = false;
+
+  // Hand off to the I/O thread.  The write is collected by the next
+  // commit (or by the wait for the final dump, so that the file is
+  // whole when the run ends).  Once every process has written its
+  // part, the file may be used by OutCHKPT.
+  //
+  double tdump = tnow;
+  bool   full  = not real4;
+
+  writer->commit([fname, tdump, full](bool ok)
+  {
+    int bad = ok ? 0 : 1;
+    MPI_Allreduce(MPI_IN_PLACE, &bad, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    if (full and bad==0) {
+      lastPS  = fname;
+      lastPST = tdump;
+    }
+    if (full and pendingPST == tdump) pendingPS.reset();
+  });
+
+  // The previous dump's callback has run in commit(), so this one
+  // may now be advertised to OutCHKPT
+  //
+  if (full) {
+    pendingPS  = writer;
+    pendingPST = tdump;
+  }
+
+  if (last) writer->wait();
+}
@@ -18,7 +18,9 @@ OutPSQ::valid_keys = {
   "nbeg",
   "real4",
   "timer",
-  "threads"
+  "threads",
+  "async",
+  "asyncMB"
 };
 
 OutPSQ::OutPSQ(const YAML::Node& conf) : Output(conf)
@@ -78,6 +80,16 @@ void OutPSQ::initialize()
       threads = Output::conf["threads"].as<int>();
     else
       threads = 0;
+
+    if (Output::conf["async"])
+      async = Output::conf["async"].as<bool>();
+    else
+      async = false;
+
+    if (Output::conf["asyncMB"])
+      asyncMB = Output::conf["asyncMB"].as<int>();
+    else
+      asyncMB = 1024;
   }
   catch (YAML::Exception & error) {
     if (myid==0) std::cout << "Error parsing parameters in OutPSQ: "
@@ -120,6 +132,9 @@ void OutPSQ::initialize()
     //
     MPI_Bcast(&nbeg, 1, MPI_INT, 0, MPI_COMM_WORLD);
   }
+
+  if (async)
+    writer = std::make_shared<AsyncWriter>(size_t(asyncMB) << 20);
 }
 
 
@@ -154,13 +169,15 @@ void OutPSQ::Run(int n, int mstep, bool last)
 		<< "> . . . quitting" << std::endl;
       nOK = 1;
     }
-				// Used by OutCHKPT to not duplicate a dump
-    if (not real4) lastPSQ = fname.str();
+				// Used by OutCHKPT to not duplicate a dump;
+				// async pieces are incomplete until the
+				// background write finishes
+    if (not real4 and not async) lastPSQ = fname.str();
 				// Open file and write master header
     if (nOK==0) {
       struct MasterHeader header;
       header.time  = tnow;
-      header.ntot  = comp->ntot;
+      header.setTotal(comp->ntot);
       header.ncomp = comp->ncomp;
 
       out.write((char *)&header, sizeof(MasterHeader));
@@ -173,6 +190,8 @@ void OutPSQ::Run(int n, int mstep, bool last)
     exit(33);
   }
 
+  if (async) writer->begin();
+
   int count = 0;
   for (auto c : comp->components) {
 
@@ -197,8 +216,15 @@ void OutPSQ::Run(int n, int mstep, bool last)
 
     cname << "-" << myid;
     
-				// Open particle file and write
     std::string blobfile = outdir + cname.str();
+
+				// Stage particles for the I/O thread
+    if (async) {
+      c->stage_binary_particles(*writer, writer->file(blobfile, true), real4);
+      continue;
+    }
+
+				// Open particle file and write
     std::ofstream pout(blobfile);
 
     if (pout.fail()) {
@@ -227,6 +253,32 @@ void OutPSQ::Run(int n, int mstep, bool last)
     }
   }
 
+				// Hand off to the I/O thread; the final
+				// dump is completed before returning.
+				// Once every process has written its
+				// pieces the dump may be used by
+				// OutCHKPTQ.
+  if (async) {
+    std::string name  = fname.str();
+    double      tdump = tnow;
+    bool        full  = not real4;
+
+    writer->commit([name, tdump, full](bool ok)
+    {
+      int bad = ok ? 0 : 1;
+      MPI_Allreduce(MPI_IN_PLACE, &bad, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+      if (full and bad==0 and myid==0) lastPSQ = name;
+      if (full and pendingPSQT == tdump) pendingPSQ.reset();
+    });
+
+    if (full) {
+      pendingPSQ  = writer;
+      pendingPSQT = tdump;
+    }
+
+    if (last) writer->wait();
+  }
+
   if (myid==0) {
     if (out.fail()) {
       std::cout << "OutPSQ: error writing component to master <" << master
@@ -191,7 +191,7 @@ void OutPSR::Run(int n, int mstep, bool last)
     if (nOK==0) {
       struct MasterHeader header;
       header.time  = tnow;
-      header.ntot  = comp->ntot;
+      header.setTotal(comp->ntot);
       header.ncomp = comp->ncomp;
 
       out.write((char *)&header, sizeof(MasterHeader));
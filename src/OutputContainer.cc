@@ -2,6 +2,7 @@
 #include "expand.H"
 
 #include <OutputContainer.H>
+#include <Profile.H>
 
 #include <OutLog.H>
 #include <OrbTrace.H>
@@ -161,7 +162,11 @@ void OutputContainer::Run(int nstep, int mstep, bool final)
 
   // Loop through all instances
   //
-  for (auto it : out) it->Run(nstep, mstep, final);
+  for (auto it : out) {
+    Profile::Scope prof;
+    if (Profile::enabled()) prof.begin("output." + it->id);
+    it->Run(nstep, mstep, final);
+  }
   
   // Root node output
   //
@@ -5,6 +5,7 @@
 
 #include "global.H"
 #include "ParticleFerry.H"
+#include "Profile.H"
 // #include "pHOT.H"
 
 // #define DEBUG
@@ -282,7 +283,7 @@ ParticleFerry::~ParticleFerry()
 // Set up for sending <total> number of Particles to node <to> from
 // node <from>
 //
-void ParticleFerry::ShipParticles(unsigned to, unsigned from, unsigned& total)
+void ParticleFerry::ShipParticles(unsigned to, unsigned from, unsigned long& total)
 {
   MPI_Status status;
 
@@ -291,14 +292,14 @@ void ParticleFerry::ShipParticles(unsigned to, unsigned from, unsigned& total)
   _total = total;
 
   if (_from == myid) {
-    MPI_Send(&_total, 1, MPI_UNSIGNED, _to, 29, MPI_COMM_WORLD);
+    MPI_Send(&_total, 1, MPI_UNSIGNED_LONG, _to, 29, MPI_COMM_WORLD);
     bufpos    = 0;
     ibufcount = 0;
     itotcount = 0;
   }
   
   if (_to == myid) {
-    MPI_Recv(&_total, 1, MPI_UNSIGNED, _from, 29, MPI_COMM_WORLD, &status);
+    MPI_Recv(&_total, 1, MPI_UNSIGNED_LONG, _from, 29, MPI_COMM_WORLD, &status);
     bufpos    = 0;
     ibufcount = 0;
     itotcount = 0;
@@ -373,3 +374,90 @@ void ParticleFerry::BufferRecv()
   bufferKeyCheck();
 #endif
 }
+
+std::vector<PartPtr>
+ParticleFerry::Exchange(std::vector<std::vector<PartPtr>>& out)
+{
+  // Particle counts to and from each process
+  //
+  std::vector<int> scount(numprocs, 0), rcount(numprocs);
+  for (int n=0; n<numprocs; n++) scount[n] = out[n].size();
+  scount[myid] = 0;		// Nothing to ship to self
+
+  MPI_Alltoall(scount.data(), 1, MPI_INT, rcount.data(), 1, MPI_INT,
+	       MPI_COMM_WORLD);
+
+  std::vector<int> sdispl(numprocs, 0), rdispl(numprocs, 0);
+  for (int n=1; n<numprocs; n++) {
+    sdispl[n] = sdispl[n-1] + scount[n-1];
+    rdispl[n] = rdispl[n-1] + rcount[n-1];
+  }
+
+  size_t nsend = static_cast<size_t>(sdispl[numprocs-1]) + scount[numprocs-1];
+  size_t nrecv = static_cast<size_t>(rdispl[numprocs-1]) + rcount[numprocs-1];
+
+  // Pack the outgoing particles by destination
+  //
+  std::vector<char> sbuf(nsend*bufsiz), rbuf(nrecv*bufsiz);
+
+  for (int n=0; n<numprocs; n++) {
+    for (int k=0; k<scount[n]; k++)
+      particlePack(out[n][k], &sbuf[(static_cast<size_t>(sdispl[n]) + k)*bufsiz]);
+  }
+
+  // One particle is one element so that the counts stay in range
+  // for large exchanges
+  //
+  MPI_Datatype ptype;
+  MPI_Type_contiguous(bufsiz, MPI_CHAR, &ptype);
+  MPI_Type_commit(&ptype);
+
+  Profile::Scope prof;
+  if (Profile::enabled())
+    prof.begin("mpi.exchange", nsend, (nsend + nrecv)*bufsiz);
+
+  if (PFalltoall) {
+    MPI_Alltoallv(sbuf.data(), scount.data(), sdispl.data(), ptype,
+		  rbuf.data(), rcount.data(), rdispl.data(), ptype,
+		  MPI_COMM_WORLD);
+  } else {
+    std::vector<MPI_Request> req;
+    req.reserve(2*numprocs);
+
+    for (int n=0; n<numprocs; n++) {
+      if (rcount[n]==0) continue;
+      req.emplace_back();
+      MPI_Irecv(&rbuf[static_cast<size_t>(rdispl[n])*bufsiz], rcount[n], ptype, n, 31,
+		MPI_COMM_WORLD, &req.back());
+    }
+
+    for (int n=0; n<numprocs; n++) {
+      if (scount[n]==0) continue;
+      req.emplace_back();
+      MPI_Isend(&sbuf[static_cast<size_t>(sdispl[n])*bufsiz], scount[n], ptype, n, 31,
+		MPI_COMM_WORLD, &req.back());
+    }
+
+    MPI_Waitall(req.size(), req.data(), MPI_STATUSES_IGNORE);
+  }
+
+  MPI_Type_free(&ptype);
+
+  // Unpack into a single block
+  //
+  auto block = std::make_shared<std::vector<Particle>>
+    (nrecv, Particle(nimax, ndmax));
+
+  std::vector<PartPtr> ret(nrecv);
+
+  for (size_t k=0; k<nrecv; k++) {
+    ret[k] = PartPtr(block, &(*block)[k]);
+    particleUnpack(ret[k], &rbuf[k*bufsiz]);
+    if (ret[k]->indx==0 || ret[k]->mass<=0.0 || std::isnan(ret[k]->mass)) {
+      std::cout << "BAD MASS! [indx=" << ret[k]->indx
+		<< ", mass=" << ret[k]->mass << "]" << std::endl;
+    }
+  }
+
+  return ret;
+}
@@ -240,11 +240,15 @@ PolarBasis::PolarBasis(Component* c0, const YAML::Node& conf, MixtureBasis *m) :
   for (auto & v : expcoef ) v = std::make_shared<Eigen::VectorXd>(nmax);
   for (auto & v : expcoef1) v = std::make_shared<Eigen::VectorXd>(nmax);
   
+  // Per-thread accumulators are allocated by the pool thread that
+  // fills them so that they are local to its NUMA node
+  //
   expcoef0.resize(nthrds);
-  for (auto & t : expcoef0) {
-    t.resize(2*Mmax+1);
-    for (auto & v : t) v = std::make_shared<Eigen::VectorXd>(nmax);
-  }
+  ThreadPool::get().run(nthrds, [this](int id) {
+    expcoef0[id].resize(2*Mmax+1);
+    for (auto & v : expcoef0[id])
+      v = std::make_shared<Eigen::VectorXd>(Eigen::VectorXd::Zero(nmax));
+  });
 
   // Allocate normalization matrix
 
@@ -1347,19 +1351,22 @@ void * PolarBasis::determine_acceleration_and_potential_thread(void * arg)
 
     if (nbodies==0) continue;
 
-    int nbeg = nbodies*(id  )/nthrds;
-    int nend = nbodies*(id+1)/nthrds;
+    // Chunks of this level: this thread's slice first, then chunks
+    // stolen from the other threads' slices
+    //
+    int nend = 0;
 
 #ifdef DEBUG
     pthread_mutex_lock(&io_lock);
     std::cout << "Process " << myid << ": in thread"
 	      << " id=" << id 
-	      << " level=" << lev
-	      << " nbeg=" << nbeg << " nend=" << nend << std::endl;
+	      << " level=" << lev << std::endl;
     pthread_mutex_unlock(&io_lock);
 #endif
 
-    for (int i=nbeg; i<nend; i++) {
+    for (int i=0; ; i++) {
+
+      if (i>=nend and not work[lev].next(id, i, nend)) break;
 
       int indx = cC->levlist[lev][i];
 
@@ -1806,6 +1813,7 @@ void PolarBasis::dump_coefs_h5(const std::string& file)
     // And the new coefficients and write the new HDF5
     cylCoefs.clear();
     cylCoefs.add(cur);
+    cylCoefs.setH5Layout(h5series, h5chunk, h5deflate, h5shuffle);
     cylCoefs.WriteH5Coefs(file);
   }
 }
@@ -2,8 +2,12 @@
 #include <sys/time.h>
 #include <time.h>
 
+#include <chrono>
+
 #include "expand.H"
 #include <PotAccel.H>
+#include <Profile.H>
+#include <ThreadPool.H>
 
 extern "C"
 void *
@@ -11,10 +15,13 @@ call_any_threads_thread_call(void *atp)
 {
   thrd_pass_PotAccel *tp = (thrd_pass_PotAccel *)atp;
   PotAccel *p = (PotAccel *)tp->t;
+  auto beg = std::chrono::steady_clock::now();
   if (tp->coef)
     p -> determine_coefficients_thread((void*)&tp->id);
   else
     p -> determine_acceleration_and_potential_thread((void*)&tp->id);
+  std::chrono::duration<double> dt = std::chrono::steady_clock::now() - beg;
+  tp->dt = dt.count();
   return NULL;
 }
                    
@@ -33,7 +40,18 @@ std::map<PotAccel::Geometry, std::string> PotAccel::geoname =
 void PotAccel::exp_thread_fork(bool coef)
 {
   //
-  // If only one thread, skip pthread call
+  // Work-stealing ranges over the level lists of the component being
+  // evaluated
+  //
+  Component *c = coef ? component : cC;
+  if (c) {
+    if (work.size() < c->levlist.size()) work.resize(c->levlist.size());
+    for (unsigned lev=0; lev<c->levlist.size(); lev++)
+      work[lev].reset(c->levlist[lev].size(), nthrds);
+  }
+
+  //
+  // If only one thread, skip the pool
   //
   if (nthrds==1) {
 
@@ -45,14 +63,12 @@ void PotAccel::exp_thread_fork(bool coef)
 
     call_any_threads_thread_call(&td);
 
+    if (Profile::enabled()) Profile::threads({td.dt});
+
     return;
   }
 
-  int errcode;
-  void *retval;
-  
   td = new thrd_pass_PotAccel [nthrds];
-  t = new pthread_t [nthrds];
 
   if (!td) {
     std::ostringstream sout;
@@ -60,12 +76,6 @@ void PotAccel::exp_thread_fork(bool coef)
 	 << ": exp_thread_fork: error allocating memory for thread counters";
     throw GenericError(sout.str(), __FILE__, __LINE__, 1027, true);
   }
-  if (!t) {
-    std::ostringstream sout;
-    sout << "Process " << myid
-	 << ": exp_thread_fork: error allocating memory for thread\n";
-    throw GenericError(sout.str(), __FILE__, __LINE__, 1027, true);
-  }
 
   //
   // For determining time in threaded routines
@@ -88,42 +98,15 @@ void PotAccel::exp_thread_fork(bool coef)
 
   }
 
-				// Make the <nthrds> threads
   for (int i=0; i<nthrds; i++) {
     td[i].t = this;
     td[i].coef = coef;
     td[i].id = i;
-
-    errcode =  pthread_create(&t[i], 0, call_any_threads_thread_call, &td[i]);
-    if (errcode) {
-      std::ostringstream sout;
-      sout << "Process " << myid;
-      if (coef)	sout << ", make_coefficients";
-      else sout << ", determine_acceleration";
-      sout << " thread: cannot make thread " << i
-	   << ", errcode=" << errcode;
-      throw GenericError(sout.str(), __FILE__, __LINE__, 1027, true);
-    }
-#ifdef DEBUG
-    else {
-      cout << "Process " << myid << ": thread <" << i << "> created\n";
-    }
-#endif
-  }
-    
-				// Collapse the threads
-  for (int i=0; i<nthrds; i++) {
-    if ((errcode=pthread_join(t[i], &retval))) {
-      std::ostringstream sout;
-      sout << "Process " << myid;
-      if (coef)	sout << ", make_coefficients";
-      else sout << ", determine_acceleration";
-      sout << " thread: thread join " << i
-	   << " failed, errcode=" << errcode;
-      throw GenericError(sout.str(), __FILE__, __LINE__, 1027, true);
-    }
   }
-  
+
+				// Run on the persistent pool
+  ThreadPool::get().run([this](int i) { call_any_threads_thread_call(&td[i]); });
+
   //
   // For determining time in threaded routines
   //
@@ -145,8 +128,13 @@ void PotAccel::exp_thread_fork(bool coef)
 
   }
 
+  if (Profile::enabled()) {
+    std::vector<double> times(nthrds);
+    for (int i=0; i<nthrds; i++) times[i] = td[i].dt;
+    Profile::threads(times);
+  }
+
   delete [] td;
-  delete [] t;
 
 }
 
@@ -189,6 +177,10 @@ PotAccel::PotAccel(Component* c0, const YAML::Node& CONF) : conf(CONF)
   coef_dump    = false;
   play_back    = false;
   play_cnew    = false;
+  h5series     = false;
+  h5shuffle    = false;
+  h5chunk      = 256;
+  h5deflate    = 0;
   compute      = false;
   dof          = 3;
   mlevel       = 0;
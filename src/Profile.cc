@@ -0,0 +1,222 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+#include <cctype>
+
+#include "expand.H"
+#include <global.H>
+
+#include <Profile.H>
+
+std::vector<Profile::Region> Profile::regions;
+std::map<std::string, int>   Profile::lookup;
+std::vector<int>             Profile::active;
+int                          Profile::last = 0;
+
+bool Profile::enabled()
+{
+  return nprofile>0;
+}
+
+int Profile::region(const std::string& name)
+{
+  auto it = lookup.find(name);
+  if (it != lookup.end()) return it->second;
+
+  // The report is whitespace separated and written as CSV and JSON
+  //
+  std::string label(name);
+  for (auto & c : label) {
+    if (std::isspace(c) or c==',' or c=='"' or c=='\\') c = '_';
+  }
+
+  int id = regions.size();
+  regions.emplace_back();
+  regions.back().name = label;
+  lookup[name] = id;
+
+  return id;
+}
+
+void Profile::start(int id)
+{
+  if (nprofile<=0) return;
+
+  regions[id].beg = Clock::now();
+  active.push_back(id);
+}
+
+void Profile::stop(int id, unsigned long parts, unsigned long bytes)
+{
+  if (nprofile<=0) return;
+
+  Region& r = regions[id];
+  std::chrono::duration<double> dt = Clock::now() - r.beg;
+
+  r.time  += dt.count();
+  r.calls += 1;
+  r.parts += parts;
+  r.bytes += bytes;
+
+  auto it = std::find(active.rbegin(), active.rend(), id);
+  if (it != active.rend()) active.erase(std::next(it).base());
+}
+
+void Profile::count(int id, unsigned long parts, unsigned long bytes)
+{
+  if (nprofile<=0) return;
+
+  regions[id].parts += parts;
+  regions[id].bytes += bytes;
+}
+
+void Profile::add(int id, double time)
+{
+  if (nprofile<=0) return;
+
+  regions[id].time  += time;
+  regions[id].calls += 1;
+}
+
+void Profile::threads(const std::vector<double>& times)
+{
+  if (nprofile<=0 or active.empty()) return;
+
+  auto & t = regions[active.back()].tthrd;
+  if (t.size() < times.size()) t.resize(times.size(), 0.0);
+  for (size_t i=0; i<times.size(); i++) t[i] += times[i];
+}
+
+void Profile::report(int n)
+{
+  if (nprofile<=0 or n % nprofile) return;
+
+  // Serialize this process' regions.  Names may differ between
+  // processes so they are matched by name on the root.
+  //
+  std::ostringstream sout;
+  sout << std::setprecision(10);
+  for (auto & r : regions) {
+    double imb = 1.0;
+    if (r.tthrd.size()) {
+      double tmax = *std::max_element(r.tthrd.begin(), r.tthrd.end()), tsum = 0.0;
+      for (auto v : r.tthrd) tsum += v;
+      if (tsum>0.0) imb = tmax*r.tthrd.size()/tsum;
+    }
+    sout << r.name  << " " << r.time  << " " << r.calls << " "
+	 << r.parts << " " << r.bytes << " " << imb << "\n";
+  }
+
+  std::string buf = sout.str();
+  int len = buf.size();
+
+  std::vector<int> lens(numprocs), disp(numprocs, 0);
+  MPI_Gather(&len, 1, MPI_INT, lens.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+  int total = 0;
+  if (myid==0) {
+    for (int i=0; i<numprocs; i++) { disp[i] = total; total += lens[i]; }
+  }
+
+  std::vector<char> all(total+1, 0);
+  MPI_Gatherv(buf.data(), len, MPI_CHAR, all.data(), lens.data(), disp.data(),
+	      MPI_CHAR, 0, MPI_COMM_WORLD);
+
+  if (myid==0) {
+
+    struct Sum
+    {
+      double tmax = 0.0, tsum = 0.0, imb = 1.0;
+      unsigned long calls = 0, parts = 0, bytes = 0;
+      int nproc = 0;
+    };
+
+    std::map<std::string, Sum> sums;
+    std::vector<std::string> order;
+
+    std::istringstream sin(std::string(all.data(), total));
+    std::string name;
+    double time, imb;
+    unsigned long calls, parts, bytes;
+
+    while (sin >> name >> time >> calls >> parts >> bytes >> imb) {
+      if (sums.find(name) == sums.end()) order.push_back(name);
+      Sum& s = sums[name];
+      s.tmax   = std::max<double>(s.tmax, time);
+      s.tsum  += time;
+      s.calls  = std::max<unsigned long>(s.calls, calls);
+      s.parts += parts;
+      s.bytes += bytes;
+      s.imb    = std::max<double>(s.imb, imb);
+      s.nproc++;
+    }
+
+    bool json = profile_fmt == "json";
+    std::string file = outdir + "profile." + runtag + (json ? ".json" : ".csv");
+
+    bool fresh = not std::ifstream(file).good();
+
+    std::ofstream out(file, std::ios::out | std::ios::app);
+
+    if (not out) {
+      std::cout << "Profile: error opening <" << file << ">" << std::endl;
+    } else {
+
+      // Per region: wall time max and mean over processes, process
+      // imbalance (max/mean), particles and bytes summed over
+      // processes, particle rate from the slowest process and the
+      // largest per-thread imbalance
+      //
+      if (json) {
+	out << "{\"step\": " << n << ", \"time\": " << tnow
+	    << ", \"steps\": " << n - last << ", \"regions\": [";
+      } else if (fresh) {
+	out << "step,time,steps,region,calls,wall_max,wall_mean,"
+	    << "proc_imbalance,particles,particles_per_sec,bytes,"
+	    << "thread_imbalance" << std::endl;
+      }
+
+      bool first = true;
+      for (auto & v : order) {
+	Sum& s = sums[v];
+	double mean = s.tsum/s.nproc;
+	double pimb = mean>0.0 ? s.tmax/mean : 1.0;
+	double rate = s.tmax>0.0 ? s.parts/s.tmax : 0.0;
+
+	if (json) {
+	  out << (first ? "" : ", ")
+	      << "{\"region\": \"" << v << "\""
+	      << ", \"calls\": "            << s.calls
+	      << ", \"wall_max\": "         << s.tmax
+	      << ", \"wall_mean\": "        << mean
+	      << ", \"proc_imbalance\": "   << pimb
+	      << ", \"particles\": "        << s.parts
+	      << ", \"particles_per_sec\": " << rate
+	      << ", \"bytes\": "            << s.bytes
+	      << ", \"thread_imbalance\": " << s.imb << "}";
+	} else {
+	  out << n       << "," << tnow   << "," << n - last << ","
+	      << v       << "," << s.calls << "," << s.tmax << ","
+	      << mean    << "," << pimb   << "," << s.parts << ","
+	      << rate    << "," << s.bytes << "," << s.imb
+	      << std::endl;
+	}
+	first = false;
+      }
+
+      if (json) out << "]}" << std::endl;
+    }
+  }
+
+  // Begin a new interval
+  //
+  for (auto & r : regions) {
+    r.time  = 0.0;
+    r.calls = r.parts = r.bytes = 0;
+    r.tthrd.clear();
+  }
+
+  last = n;
+}
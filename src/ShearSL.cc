@@ -377,6 +377,7 @@ void ShearSL::dump_coefs_h5(const std::string& file)
     // And the new coefficients and write the new HDF5
     slabCoefs.clear();
     slabCoefs.add(cur);
+    slabCoefs.setH5Layout(h5series, h5chunk, h5deflate, h5shuffle);
     slabCoefs.WriteH5Coefs(file);
   }
 }
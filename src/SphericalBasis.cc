@@ -44,7 +44,8 @@ SphericalBasis::valid_keys = {
   "playback",
   "coefCompute",
   "coefMaster",
-  "orthocheck"
+  "orthocheck",
+  "tileSize"
 };
 
 SphericalBasis::SphericalBasis(Component* c0, const YAML::Node& conf, MixtureBasis *m) : 
@@ -83,6 +84,7 @@ SphericalBasis::SphericalBasis(Component* c0, const YAML::Node& conf, MixtureBas
   cuda_aware       = true;
 #endif
   ortho_check      = false;
+  tileSize         = 64;
 
   // Remove matched keys
   //
@@ -198,6 +200,8 @@ SphericalBasis::SphericalBasis(Component* c0, const YAML::Node& conf, MixtureBas
     // END: playback config
 
     if (conf["orthocheck"]) ortho_check = conf["orthocheck"].as<bool>();
+
+    if (conf["tileSize"]) tileSize = conf["tileSize"].as<int>();
   }
   catch (YAML::Exception & error) {
     if (myid==0) std::cout << "Error parsing parameters in SphericalBasis: "
@@ -253,11 +257,15 @@ SphericalBasis::SphericalBasis(Component* c0, const YAML::Node& conf, MixtureBas
   for (auto & v : expcoef ) v = std::make_shared<Eigen::VectorXd>(nmax);
   for (auto & v : expcoef1) v = std::make_shared<Eigen::VectorXd>(nmax);
   
+  // Per-thread accumulators are allocated by the pool thread that
+  // fills them so that they are local to its NUMA node
+  //
   expcoef0.resize(nthrds);
-  for (auto & t : expcoef0) {
-    t.resize((Lmax+1)*(Lmax+1));
-    for (auto & v : t) v = std::make_shared<Eigen::VectorXd>(nmax);
-  }
+  ThreadPool::get().run(nthrds, [this](int id) {
+    expcoef0[id].resize((Lmax+1)*(Lmax+1));
+    for (auto & v : expcoef0[id])
+      v = std::make_shared<Eigen::VectorXd>(Eigen::VectorXd::Zero(nmax));
+  });
 
   // Allocate normalization matrix
 
@@ -300,6 +308,28 @@ SphericalBasis::SphericalBasis(Component* c0, const YAML::Node& conf, MixtureBas
   for (auto & v : legs)  v.resize(Lmax+1, Lmax+1);
   for (auto & v : dlegs) v.resize(Lmax+1, Lmax+1);
 
+  // Particle tiles for batched evaluation
+  //
+  if (tileSize>1) {
+    tileR.resize(nthrds);
+    tileY.resize(nthrds);
+
+    for (auto & v : tileR) v.resize((Lmax+1)*nmax, tileSize);
+    for (auto & v : tileY) v.resize(tileSize, (Lmax+1)*(Lmax+1));
+
+    tileD .resize(nthrds);
+    tileYD.resize(nthrds);
+    tileYP.resize(nthrds);
+    tileG .resize(nthrds);
+    tileI .resize(nthrds);
+
+    for (auto & v : tileD ) v.resize((Lmax+1)*nmax, tileSize);
+    for (auto & v : tileYD) v.resize(tileSize, (Lmax+1)*(Lmax+1));
+    for (auto & v : tileYP) v.resize(tileSize, (Lmax+1)*(Lmax+1));
+    for (auto & v : tileG ) v.resize(tileSize, 5);
+    for (auto & v : tileI ) v.resize(tileSize);
+  }
+
   // Work vectors
   //
   u. resize(nthrds);
@@ -445,27 +475,49 @@ void * SphericalBasis::determine_coefficients_thread(void * arg)
   if (subset) nend = (int)floor(ssfrac*nend);
 
   unsigned whch = 0;		// For PCA jacknife
+  int Lsize = (Lmax+1)*(Lmax+2)/2;
+
+				// Use the slot mirror if packed
+  bool soa = component->SoA(mlevel);
+  unsigned sbeg = soa ? component->SoABeg(mlevel) : 0;
+
+  unsigned flags = Component::Local;
+  if (not mix) flags |= Component::Centered;
+
+				// Batch the particles into tiles
+				// unless accumulating PCA variance
+  bool batch = tileSize>1 and not (compute and (pcavar or pcaeof));
+  int ntile = 0;
 
   for (int i=nbeg; i<nend; i++) {
 
-    int indx = component->levlist[mlevel][i];
+    int indx;
+    double mass, pos[3];
 
-    if (component->freeze(indx)) continue;
+    if (soa) {
+      unsigned s = sbeg + i;
 
-    
-    double mass = component->Mass(indx) * adb;
+      if (component->SoAFreeze(s)) continue;
+
+      indx = component->SoAIndex(s);
+      mass = component->SoAMass(s) * adb;
+      component->SoAPos(pos, s, flags);
+    } else {
+      indx = component->levlist[mlevel][i];
+
+      if (component->freeze(indx)) continue;
+
+      mass = component->Mass(indx) * adb;
+      component->Pos(pos, indx, flags);
+    }
 				// Adjust mass for subset
     if (subset) mass /= ssfrac;
     
-    double xx, yy, zz;
+    double xx = pos[0], yy = pos[1], zz = pos[2];
     if (mix) {
-      xx = component->Pos(indx, 0, Component::Local) - ctr[0];
-      yy = component->Pos(indx, 1, Component::Local) - ctr[1];
-      zz = component->Pos(indx, 2, Component::Local) - ctr[2];
-    } else {
-      xx = component->Pos(indx, 0, Component::Local | Component::Centered);
-      yy = component->Pos(indx, 1, Component::Local | Component::Centered);
-      zz = component->Pos(indx, 2, Component::Local | Component::Centered);
+      xx -= ctr[0];
+      yy -= ctr[1];
+      zz -= ctr[2];
     }
 
     double r2 = (xx*xx + yy*yy + zz*zz);
@@ -487,12 +539,37 @@ void * SphericalBasis::determine_coefficients_thread(void * arg)
 	muse1[id] += mass;
 	if (pcavar) {
 	  whch = indx % sampT;
-	  pthread_mutex_lock(&cc_lock);
-	  massT1[whch] += mass;
-	  pthread_mutex_unlock(&cc_lock);
+	  massT1t[id][whch] += mass;
 	}
       }
 
+      // Batched accumulation: copy the radial and angular functions
+      // into the tile and reduce when full
+      //
+      if (batch) {
+	auto & R = tileR[id];
+	auto & Y = tileY[id];
+
+	for (int l=0; l<=Lmax; l++)
+	  R.col(ntile).segment(l*nmax, nmax) = potd[id].row(l).transpose();
+
+	for (int l=0, loffset=0; l<=Lmax; loffset+=(2*l+1), l++) {
+	  Y(ntile, loffset) = factorial(l, 0) * legs[id](l, 0) * mass;
+	  for (int m=1, moffset=1; m<=l; m++, moffset+=2) {
+	    double facL = factorial(l, m) * legs[id](l, m) * mass;
+	    Y(ntile, loffset+moffset  ) = facL*cosm[id][m];
+	    Y(ntile, loffset+moffset+1) = facL*sinm[id][m];
+	  }
+	}
+
+	if (++ntile == tileSize) {
+	  accumulate_coefficient_tile(id, ntile);
+	  ntile = 0;
+	}
+
+	continue;
+      }
+
       //		l loop
       for (int l=0, loffset=0, iC=0; l<=Lmax; loffset+=(2*l+1), l++) {
 	//		m loop
@@ -507,23 +584,15 @@ void * SphericalBasis::determine_coefficients_thread(void * arg)
 	    }
 
 	    if (compute and pcavar) {
-	      pthread_mutex_lock(&cc_lock);
-	      for (int n=0; n<nmax; n++) {
-		(*expcoefT1[whch][iC])[n] += wk[n];
-		for (int o=0; o<nmax; o++)
-		  (*expcoefM1[whch][iC])(n, o) += wk[n]*wk[o]/mass;
-	      }
-	      pthread_mutex_unlock(&cc_lock);
+	      Eigen::Map<Eigen::VectorXd> W(wk.data(), nmax);
+	      coefT1t[id].col(whch*Lsize + iC) += W;
+	      covT1t[id].middleCols((whch*Lsize + iC)*nmax, nmax) +=
+		W*W.transpose()/mass;
 	    }
 
 	    if (compute and pcaeof) {
-	      pthread_mutex_lock(&cc_lock);
-	      for (int n=0; n<nmax; n++) {
-		for (int o=0; o<nmax; o++) {
-		  (*tvar[iC])(n, o) += wk[n]*wk[o]/mass;
-		}
-	      }
-	      pthread_mutex_unlock(&cc_lock);
+	      Eigen::Map<Eigen::VectorXd> W(wk.data(), nmax);
+	      tvart[id][iC] += W*W.transpose()/mass;
 	    }
 
 	    iC++;
@@ -544,23 +613,15 @@ void * SphericalBasis::determine_coefficients_thread(void * arg)
 	      }
 
 	      if (compute and pcavar) {
-		pthread_mutex_lock(&cc_lock);
-		for (int n=0; n<nmax; n++) {
-		  (*expcoefT1[whch][iC])[n] += wk[n]*facL;
-		  for (int o=0; o<nmax; o++)
-		    (*expcoefM1[whch][iC])(n, o) += wk[n]*wk[o]*facL*facL/mass;
-		}
-		pthread_mutex_unlock(&cc_lock);
+		Eigen::Map<Eigen::VectorXd> W(wk.data(), nmax);
+		coefT1t[id].col(whch*Lsize + iC) += W*facL;
+		covT1t[id].middleCols((whch*Lsize + iC)*nmax, nmax) +=
+		  W*W.transpose()*facL*facL/mass;
 	      }
 	    
 	      if (compute and pcaeof) {
-		pthread_mutex_lock(&cc_lock);
-		for (int n=0; n<nmax; n++) {
-		  for (int o=0; o<nmax; o++) {
-		    (*tvar[iC])(n, o) += wk[n]*wk[o]/mass;
-		  }
-		}
-		pthread_mutex_unlock(&cc_lock);
+		Eigen::Map<Eigen::VectorXd> W(wk.data(), nmax);
+		tvart[id][iC] += W*W.transpose()/mass;
 	      }
 	    }
 
@@ -576,12 +637,41 @@ void * SphericalBasis::determine_coefficients_thread(void * arg)
 
   } // particle loop
 
+				// Reduce the partial tile
+  if (ntile) accumulate_coefficient_tile(id, ntile);
+
   thread_timing_end(id);
 
   return (NULL);
 }
 
 
+void SphericalBasis::accumulate_coefficient_tile(int id, int k)
+{
+  // Biorthgonal normalization factor
+  //
+  constexpr double fac0 = -4.0*M_PI;
+
+  // For each l, the coefficient block for the (2l+1) angular terms is
+  // the product of the radial tile (nmax x k) with the angular tile
+  // (k x (2l+1))
+  //
+  for (int l=0, loffset=0; l<=Lmax; loffset+=(2*l+1), l++) {
+
+    int ncol = M0_only ? 1 : 2*l + 1;
+
+    Eigen::MatrixXd C =
+      tileR[id].block(l*nmax, 0, nmax, k) *
+      tileY[id].block(0, loffset, k, ncol);
+
+    Eigen::VectorXd norm = fac0 * sqnorm.row(l).transpose().cwiseInverse();
+
+    for (int j=0; j<ncol; j++)
+      *expcoef0[id][loffset+j] += C.col(j).cwiseProduct(norm);
+  }
+}
+
+
 void SphericalBasis::determine_coefficients(void)
 {
   if (play_back) {
@@ -718,6 +808,22 @@ void SphericalBasis::determine_coefficients_particles(void)
 	for (auto & v : t) v = std::make_shared<Eigen::MatrixXd>(nmax, nmax);
       }
 
+      if (pcavar) {
+	massT1t.resize(nthrds);
+	coefT1t.resize(nthrds);
+	covT1t .resize(nthrds);
+	for (auto & v : massT1t) v.resize(sampT, 0.0);
+	for (auto & v : coefT1t) v.setZero(nmax, sampT*(Lmax+1)*(Lmax+2)/2);
+	for (auto & v : covT1t ) v.setZero(nmax, nmax*sampT*(Lmax+1)*(Lmax+2)/2);
+      }
+    }
+
+    if (pcaeof and tvart.size()==0) {
+      tvart.resize(nthrds);
+      for (auto & t : tvart) {
+	t.resize((Lmax+1)*(Lmax+2)/2);
+	for (auto & v : t) v.setZero(nmax, nmax);
+      }
     }
 
     // Zero arrays?
@@ -814,6 +920,10 @@ void SphericalBasis::determine_coefficients_particles(void)
   cout << "Process " << myid << ": in <determine_coefficients>, thread returned, lev=" << mlevel << endl;
 #endif
 
+  // Sum up the PCA accumulators from each thread
+  //
+  if (compute) merge_pca_threads();
+
   // Sum up the results from each thread
   //
   for (int i=0; i<nthrds; i++) use1 += use[i];
@@ -962,6 +1072,36 @@ void SphericalBasis::determine_coefficients_particles(void)
   firstime_coef = false;
 }
 
+void SphericalBasis::merge_pca_threads()
+{
+  int Lsize = (Lmax+1)*(Lmax+2)/2;
+
+  if (pcavar) {
+    for (int n=0; n<nthrds; n++) {
+      for (unsigned T=0; T<sampT; T++) {
+	massT1[T] += massT1t[n][T];
+	massT1t[n][T] = 0.0;
+	for (int l=0; l<Lsize; l++) {
+	  *expcoefT1[T][l] += coefT1t[n].col(T*Lsize + l);
+	  *expcoefM1[T][l] += covT1t[n].middleCols((T*Lsize + l)*nmax, nmax);
+	}
+      }
+      coefT1t[n].setZero();
+      covT1t [n].setZero();
+    }
+  }
+
+  if (pcaeof) {
+    for (int n=0; n<nthrds; n++) {
+      for (int l=0; l<Lsize; l++) {
+	*tvar[l] += tvart[n][l];
+	tvart[n][l].setZero();
+      }
+    }
+  }
+}
+
+
 void SphericalBasis::multistep_reset()
 {
   if (play_back and not play_cnew) return;
@@ -1455,6 +1595,15 @@ void * SphericalBasis::determine_acceleration_and_potential_thread(void * arg)
 
   thread_timing_beg(id);
 
+  // Use the slot mirror if packed
+  //
+  bool soa = cC->SoA(mlevel);
+
+  // Batch the particles into tiles
+  //
+  bool batch = tileSize>1;
+  int ntile = 0;
+
   // If we are multistepping, compute accel only at or above <mlevel>
   //
   for (int lev=mlevel; lev<=multistep; lev++) {
@@ -1463,30 +1612,49 @@ void * SphericalBasis::determine_acceleration_and_potential_thread(void * arg)
 
     if (nbodies==0) continue;
 
-    int nbeg = nbodies*(id  )/nthrds;
-    int nend = nbodies*(id+1)/nthrds;
+    // Chunks of this level: this thread's slice first, then chunks
+    // stolen from the other threads' slices
+    //
+    int nend = 0;
+
+    unsigned sbeg = soa ? cC->SoABeg(lev) : 0;
 
 #ifdef DEBUG
     pthread_mutex_lock(&io_lock);
     std::cout << "Process " << myid << ": in thread"
 	      << " id=" << id 
-	      << " level=" << lev
-	      << " nbeg=" << nbeg << " nend=" << nend << std::endl;
+	      << " level=" << lev << std::endl;
     pthread_mutex_unlock(&io_lock);
 #endif
 
-    for (int i=nbeg; i<nend; i++) {
+    for (int i=0; ; i++) {
 
-      int indx = cC->levlist[lev][i];
+      if (i>=nend and not work[lev].next(id, i, nend)) break;
+
+      int indx = 0;
+      unsigned s = sbeg + i;
+
+      if (soa) {
+	if (cC->SoAFreeze(s)) continue;
+      } else {
+	indx = cC->levlist[lev][i];
+	if (cC->freeze(indx)) continue;
+      }
 
-      if (cC->freeze(indx)) continue;
+      // Get the inertial position for external evaluation
+      //
+      auto getPos = [&](unsigned flags)
+      {
+	if (soa) cC->SoAPos(pos, s, flags);
+	else     cC->Pos(pos, indx, flags);
+      };
 
       if (mix) {
 	if (use_external) {
-	  cC->Pos(pos, indx, Component::Inertial);
+	  getPos(Component::Inertial);
 	  component->ConvertPos(pos, Component::Local);
 	} else
-	  cC->Pos(pos, indx, Component::Local);
+	  getPos(Component::Local);
 
 	mfactor = mix->Mixture(pos);
 	xx = pos[0] - ctr[0];
@@ -1494,10 +1662,10 @@ void * SphericalBasis::determine_acceleration_and_potential_thread(void * arg)
 	zz = pos[2] - ctr[2];
       } else {
 	if (use_external) {
-	  cC->Pos(pos, indx, Component::Inertial);
+	  getPos(Component::Inertial);
 	  component->ConvertPos(pos, Component::Local | Component::Centered);
 	} else
-	  cC->Pos(pos, indx, Component::Local | Component::Centered);
+	  getPos(Component::Local | Component::Centered);
 	
 	xx = pos[0];
 	yy = pos[1];
@@ -1526,6 +1694,63 @@ void * SphericalBasis::determine_acceleration_and_potential_thread(void * arg)
       
       get_dpotl(Lmax, nmax, rs, potd[id], dpot[id], id);
 
+      // Batched evaluation: copy the radial and angular functions into
+      // the tile and evaluate when full
+      //
+      if (batch) {
+	auto & R  = tileR [id];
+	auto & D  = tileD [id];
+	auto & Y  = tileY [id];
+	auto & YD = tileYD[id];
+	auto & YP = tileYP[id];
+
+	for (int l=0; l<=Lmax; l++) {
+	  R.col(ntile).segment(l*nmax, nmax) = potd[id].row(l).transpose();
+	  D.col(ntile).segment(l*nmax, nmax) = dpot[id].row(l).transpose();
+	}
+
+	Y (ntile, 0) = mfactor * factorial(0, 0);
+	YD(ntile, 0) = YP(ntile, 0) = 0.0;
+
+	for (int l=1, loffset=1; l<=Lmax; loffset+=(2*l+1), l++) {
+	  for (int m=0, moffset=0; m<=l; m++) {
+
+	    double facL = factorial(l, m) *  legs[id](l, m) * mfactor;
+	    double facD = factorial(l, m) * dlegs[id](l, m) * mfactor;
+
+				// Suppressed M terms are zeroed
+	    bool skip = (EVEN_M && (m/2)*2 != m) or (M0_only and m!=0);
+	    if (skip) facL = facD = 0.0;
+
+	    if (m==0) {
+	      Y (ntile, loffset) = facL;
+	      YD(ntile, loffset) = facD;
+	      YP(ntile, loffset) = 0.0;
+	      moffset++;
+	    } else {
+	      int ic = loffset + moffset, is = ic + 1;
+	      Y (ntile, ic) =  facL*cosm[id][m];
+	      Y (ntile, is) =  facL*sinm[id][m];
+	      YD(ntile, ic) =  facD*cosm[id][m];
+	      YD(ntile, is) =  facD*sinm[id][m];
+	      YP(ntile, ic) = -facL*sinm[id][m]*m;
+	      YP(ntile, is) =  facL*cosm[id][m]*m;
+	      moffset += 2;
+	    }
+	  }
+	}
+
+	tileG[id].row(ntile) << xx, yy, zz, r, ioff ? r0 : 0.0;
+	tileI[id][ntile] = soa ? s : indx;
+
+	if (++ntile == tileSize) {
+	  accumulate_force_tile(id, ntile, soa);
+	  ntile = 0;
+	}
+
+	continue;
+      }
+
       if (!NO_L0) {
 	get_pot_coefs_safe(0, *expcoef[0], p, dp, potd[id], dpot[id]);
 	if (ioff) {
@@ -1603,16 +1828,28 @@ void * SphericalBasis::determine_acceleration_and_potential_thread(void * arg)
       pott /= scale;
       potp /= scale;
 
-      cC->AddAcc(indx, 0, -(potr*xx/r - pott*xx*zz/(r*r*r)) );
-      cC->AddAcc(indx, 1, -(potr*yy/r - pott*yy*zz/(r*r*r)) );
-      cC->AddAcc(indx, 2, -(potr*zz/r + pott*fac/(r*r*r))   );
+      double acc[3] = {-(potr*xx/r - pott*xx*zz/(r*r*r)),
+		       -(potr*yy/r - pott*yy*zz/(r*r*r)),
+		       -(potr*zz/r + pott*fac/(r*r*r))  };
       if (fac > DSMALL) {
-	cC->AddAcc(indx, 0,  potp*yy/fac );
-	cC->AddAcc(indx, 1, -potp*xx/fac );
+	acc[0] +=  potp*yy/fac;
+	acc[1] += -potp*xx/fac;
+      }
+
+      if (soa) {
+	for (int k=0; k<3; k++) cC->SoAAddAcc(s, k, acc[k]);
+	cC->SoAAddPot(s, potl);
+      } else {
+	cC->AddAcc(indx, acc);
+	cC->AddPot(indx, potl);
       }
-      cC->AddPot(indx, potl);
     }
 
+				// Evaluate the partial tile
+    if (ntile) {
+      accumulate_force_tile(id, ntile, soa);
+      ntile = 0;
+    }
   }
 
   thread_timing_end(id);
@@ -1621,6 +1858,92 @@ void * SphericalBasis::determine_acceleration_and_potential_thread(void * arg)
 }
 
 
+void SphericalBasis::accumulate_force_tile(int id, int k, bool soa)
+{
+  auto & G = tileG[id];
+
+  Eigen::ArrayXd potl = Eigen::ArrayXd::Zero(k);
+  Eigen::ArrayXd potr = Eigen::ArrayXd::Zero(k);
+  Eigen::ArrayXd pott = Eigen::ArrayXd::Zero(k);
+  Eigen::ArrayXd potp = Eigen::ArrayXd::Zero(k);
+
+  // Particles outside of rmax use the external multipole solution
+  //
+  Eigen::ArrayXd r0  = G.col(4).head(k).array();
+  Eigen::ArrayXd out = (r0 > 0.0).cast<double>();
+  Eigen::ArrayXd ir0 = out/(r0 + (1.0 - out));
+  Eigen::ArrayXd rat = out*rmax*ir0 + (1.0 - out);
+  Eigen::ArrayXd fac = rat;
+
+  // For each l, contract the coefficients with the radial tiles,
+  // (2l+1) x nmax times nmax x k, and sum the angular terms
+  //
+  for (int l=0, loffset=0; l<=Lmax; loffset+=(2*l+1), l++, fac*=rat) {
+
+    if (l==0 and NO_L0) continue;
+				// Suppress L=1 terms?
+    if (NO_L1 && l==1) continue;
+				// Suppress odd L terms?
+    if (EVEN_L && (l/2)*2 != l) continue;
+
+    int ncol = M0_only ? 1 : 2*l + 1;
+
+    auto E = coefmat.block(0, loffset, nmax, ncol).transpose();
+
+    Eigen::MatrixXd P  = E * tileR[id].block(l*nmax, 0, nmax, k);
+    Eigen::MatrixXd DP = E * tileD[id].block(l*nmax, 0, nmax, k);
+
+    Eigen::ArrayXd p  = P.cwiseProduct
+      (tileY [id].block(0, loffset, k, ncol).transpose()).colwise().sum().transpose();
+    Eigen::ArrayXd dp = DP.cwiseProduct
+      (tileY [id].block(0, loffset, k, ncol).transpose()).colwise().sum().transpose();
+    Eigen::ArrayXd pt = P.cwiseProduct
+      (tileYD[id].block(0, loffset, k, ncol).transpose()).colwise().sum().transpose();
+    Eigen::ArrayXd pp = P.cwiseProduct
+      (tileYP[id].block(0, loffset, k, ncol).transpose()).colwise().sum().transpose();
+
+    potl += fac*p;
+    potr += out*(-fac*p*ir0*(l+1.0)) + (1.0 - out)*dp;
+    pott += fac*pt;
+    potp += fac*pp;
+  }
+
+  // Spherical to Cartesian projection
+  //
+  auto xx = G.col(0).head(k).array();
+  auto yy = G.col(1).head(k).array();
+  auto zz = G.col(2).head(k).array();
+  auto r  = G.col(3).head(k).array();
+
+  potr /= scale*scale;
+  potl /= scale;
+  pott /= scale;
+  potp /= scale;
+
+  Eigen::ArrayXd fc  = xx*xx + yy*yy;
+  Eigen::ArrayXd r3  = r*r*r;
+  Eigen::ArrayXd ifc = (fc > DSMALL).select(1.0/fc, 0.0);
+
+  Eigen::ArrayXd ax = -(potr*xx/r - pott*xx*zz/r3) + potp*yy*ifc;
+  Eigen::ArrayXd ay = -(potr*yy/r - pott*yy*zz/r3) - potp*xx*ifc;
+  Eigen::ArrayXd az = -(potr*zz/r + pott*fc/r3);
+
+  for (int j=0; j<k; j++) {
+    unsigned s = tileI[id][j];
+    if (soa) {
+      cC->SoAAddAcc(s, 0, ax[j]);
+      cC->SoAAddAcc(s, 1, ay[j]);
+      cC->SoAAddAcc(s, 2, az[j]);
+      cC->SoAAddPot(s, potl[j]);
+    } else {
+      double acc[3] = {ax[j], ay[j], az[j]};
+      cC->AddAcc(s, acc);
+      cC->AddPot(s, potl[j]);
+    }
+  }
+}
+
+
 void SphericalBasis::determine_acceleration_and_potential(void)
 {
   nvTracerPtr tPtr;
@@ -1646,6 +1969,13 @@ void SphericalBasis::determine_acceleration_and_potential(void)
 
   }
 
+  // Pack the coefficients for batched evaluation
+  //
+  if (tileSize>1) {
+    coefmat.resize(nmax, (Lmax+1)*(Lmax+1));
+    for (int j=0; j<coefmat.cols(); j++) coefmat.col(j) = *expcoef[j];
+  }
+
 #if HAVE_LIBCUDA==1
   if (use_cuda and cC->cudaDevice>=0 and cC->force->cudaAware()) {
     if (cudaAccelOverride) {
@@ -1915,6 +2245,7 @@ void SphericalBasis::dump_coefs_h5(const std::string& file)
     // And the new coefficients and write the new HDF5
     sphCoefs.clear();
     sphCoefs.add(cur);
+    sphCoefs.setH5Layout(h5series, h5chunk, h5deflate, h5shuffle);
     sphCoefs.WriteH5Coefs(file);
   }
 }
@@ -13,6 +13,7 @@
 #include <expand.H>
 #include <ExternalCollection.H>
 #include <OutputContainer.H>
+#include <ThreadPool.H>
 
 void begin_run(void)
 {
@@ -53,7 +54,14 @@ void begin_run(void)
   //===================================
   
   posvel_data = vector<thrd_pass_posvel>(nthrds);
-  posvel_thrd = vector<pthread_t>       (nthrds);
+
+  //===================================
+  // Start the thread pool before any
+  // particles are allocated and report
+  // the rank and thread binding
+  //===================================
+  
+  ThreadPool::get().report();
 
   //==============================
   // Initialize multistepping
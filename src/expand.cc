@@ -19,6 +19,10 @@ void clean_up(void);
 #include <slurm/slurm.h>
 #endif
 
+#ifdef HAVE_OMP_H
+#include <omp.h>
+#endif
+
 #include <BarrierWrapper.H>
 #include <FileUtils.H>
 
@@ -307,6 +311,17 @@ main(int argc, char** argv)
 
     YAML_parse_args(argc, argv);
 
+    //============================
+    // Size the OpenMP team to the
+    // configured thread count
+    //============================
+
+    __EXP__::exp_runtime = true;
+#ifdef HAVE_OMP_H
+    omp_set_dynamic(0);
+    omp_set_num_threads(nthrds);
+#endif
+
     //============================
     // Trap floating point errors
     // by installing user handler
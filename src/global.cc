@@ -17,10 +17,12 @@ int ngpus  = 0;	                // Number of GPUs per node (0 means use all avai
 int nbalance = 0;		// Steps between load balancing
 int nreport = 0;		// Steps between particle reporting
 double dbthresh = 0.05;		// Load balancing threshold (5% by default)
+bool costbalance = false;	// Cost-model load balancing
 double dtime = 0.1;		// Default time step size
 double max_mindt = 0.05;        // Below minimum time step threshold
 
 unsigned PFbufsz = 40000;	// ParticleFerry buffer size in particles
+bool PFalltoall = true;		// Bulk exchange by MPI_Alltoallv
 
 
 bool restart = false;		// Restart from a checkpoint
@@ -29,6 +31,8 @@ int NICE = 0;			// Niceness level (default: 0)
 int VERBOSE = 1;		// Chattiness for standard output
 bool step_timing = false;	// Time parts of the step (set true by
 				// DEFAULT>3)
+int nprofile = 0;		// Steps between profile reports
+std::string profile_fmt("csv");	// Profile report format
 bool initializing = false;	// Used by force methods to do "private things"
 				// before the first step (e.g. run through
 				// coefficient evaluations even when
@@ -92,7 +96,6 @@ int cudaGlobalDevice;
 };*/
 
 vector<thrd_pass_posvel> posvel_data;
-vector<pthread_t> posvel_thrd;
 int is_init=1;
 
 				// List of host names and ranks
@@ -114,6 +117,9 @@ map<string, maker_t *, less<string> > factory;
 map<string, maker_t *, less<string> >::iterator fitr;
 
 std::string lastPS, lastPSQ, lastPSR;
+double lastPST = 0.0;
+std::shared_ptr<AsyncWriter> pendingPS, pendingPSQ;
+double pendingPST = 0.0, pendingPSQT = 0.0;
 CheckpointTimer chktimer;
 string restart_cmd;
 
@@ -3,6 +3,7 @@
 */
 
 #include "expand.H"
+#include <ThreadPool.H>
 
 #ifdef USE_GPTL
 #include <gptl.h>
@@ -85,64 +86,17 @@ void incr_position(double dt, int mlevel)
   }
 #endif
 
-  if (nthrds==1) {
-
-    posvel_data[0].dt = dt;
-    posvel_data[0].mlevel = mlevel;
-    posvel_data[0].id = 0;
-
-    incr_position_thread(&posvel_data[0]);
-
-  } else {
+  for (int i=0; i<nthrds; i++) {
+    posvel_data[i].dt = dt;
+    posvel_data[i].mlevel = mlevel;
+    posvel_data[i].id = i;
+  }
 
-    //
-    // Make the <nthrds> threads
-    //
-    int errcode;
-    void *retval;
-  
-    for (int i=0; i<nthrds; i++) {
+  //
+  // Run on the persistent thread pool
+  //
+  ThreadPool::get().run([](int i) { incr_position_thread(&posvel_data[i]); });
 
-      posvel_data[i].dt = dt;
-      posvel_data[i].mlevel = mlevel;
-      posvel_data[i].id = i;
-      
-      pthread_t *p = &posvel_thrd[i];
-      errcode =  pthread_create(p, 0, incr_position_thread, &posvel_data[i]);
-
-      if (errcode) {
-	std::ostringstream sout;
-	sout << "Process " << myid
-	     << " incr_position: cannot make thread " << i
-	     << ", errcode=" << errcode;;
-	throw GenericError(sout.str(), __FILE__, __LINE__, 1024, true);
-      }
-#ifdef DEBUG
-      else {
-	cout << "Process " << myid << ": thread <" << i << "> created\n";
-      }
-#endif
-    }
-    
-    //
-    // Collapse the threads
-    //
-    for (int i=0; i<nthrds; i++) {
-      pthread_t p = posvel_thrd[i];
-      if ((errcode=pthread_join(p, &retval))) {
-	std::ostringstream sout;
-	sout << "Process " << myid
-	     << " incr_position: thread join " << i
-	     << " failed, errcode=" << errcode;
-	throw GenericError(sout.str(), __FILE__, __LINE__, 1024, true);
-      }
-#ifdef DEBUG    
-      cout << "Process " << myid << ": incr_position thread <" 
-	   << i << "> thread exited\n";
-#endif
-    }
-  }
-  
 #ifdef USE_GPTL
   GPTLstop("incr_position");
 #endif
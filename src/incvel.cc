@@ -3,6 +3,7 @@
 */
 
 #include "expand.H"
+#include <ThreadPool.H>
 
 #ifdef USE_GPTL
 #include <gptl.h>
@@ -103,64 +104,17 @@ void incr_velocity(double dt, int mlevel)
   }
 #endif
 
-  if (nthrds==1) {
-
-    posvel_data[0].dt = dt;
-    posvel_data[0].mlevel = mlevel;
-    posvel_data[0].id = 0;
-    
-    incr_velocity_thread(&posvel_data[0]);
-
-  } else {
-
-    //
-    // Make the <nthrds> threads
-    //
-    int errcode;
-    void *retval;
-    
-    for (int i=0; i<nthrds; i++) {
-
-      posvel_data[i].dt = dt;
-      posvel_data[i].mlevel = mlevel;
-      posvel_data[i].id = i;
-      
-      pthread_t *p = &posvel_thrd[i];
-      errcode =  pthread_create(p, 0, incr_velocity_thread, &posvel_data[i]);
-
-      if (errcode) {
-	std::ostringstream sout;
-	sout << "Process " << myid
-	     << " incr_velocity: cannot make thread " << i
-	     << ", errcode=" << errcode;
-	throw GenericError(sout.str(), __FILE__, __LINE__, 1024, true);
-      }
-#ifdef DEBUG
-      else {
-	cout << "Process " << myid << ": thread <" << i << "> created\n";
-      }
-#endif
-    }
-    
-    //
-    // Collapse the threads
-    //
-    for (int i=0; i<nthrds; i++) {
-      pthread_t p = posvel_thrd[i];
-      if ((errcode=pthread_join(p, &retval))) {
-	std::ostringstream sout;
-	sout << "Process " << myid
-	     << " incr_velocity: thread join " << i
-	     << " failed, errcode=" << errcode;
-	throw GenericError(sout.str(), __FILE__, __LINE__, 1024, true);
-      }
-#ifdef DEBUG    
-      cout << "Process " << myid << ": incr_velocity thread <" 
-	   << i << "> thread exited\n";
-#endif
-    }
+  for (int i=0; i<nthrds; i++) {
+    posvel_data[i].dt = dt;
+    posvel_data[i].mlevel = mlevel;
+    posvel_data[i].id = i;
   }
 
+  //
+  // Run on the persistent thread pool
+  //
+  ThreadPool::get().run([](int i) { incr_velocity_thread(&posvel_data[i]); });
+
 #ifdef USE_GPTL
   GPTLstop("incr_velocity");
 #endif
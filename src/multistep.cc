@@ -3,6 +3,7 @@
 */
 
 #include <expand.H>
+#include <ThreadPool.H>
 #include <sstream>
 #include <chrono>
 #include <limits>
@@ -412,16 +413,6 @@ void adjust_multistep_level()
     throw GenericError(sout.str(), __FILE__, __LINE__, 1024, true);
   }
 
-  pthread_t* t  = new pthread_t [nthrds];
-
-  if (!t) {
-    std::ostringstream sout;
-    sout << "Process " << myid
-	 << ": adjust_multistep_level: error allocating memory for thread";
-    throw GenericError(sout.str(), __FILE__, __LINE__, 1024, true);
-  }
-  
-
   if (tmdt.size() == 0) {
     tmdt = std::vector< std::vector< std::vector<unsigned> > >(nthrds);
     for (int n=0; n<nthrds; n++) {
@@ -450,61 +441,16 @@ void adjust_multistep_level()
 
     for (int level=first; level<=multistep; level++) {
       
-      if (nthrds==1) {
-
-	td[0].level = level;
-	td[0].id = 0;
-	td[0].c = c;
-	
-	adjust_multistep_level_thread(&td[0]);
-	
-      } else {
-	  
-	//
-	// Make the <nthrds> threads
-	//
-	int errcode;
-	void *retval;
-	
-	for (int i=0; i<nthrds; i++) {
-	  
-	  td[i].level = level;
-	  td[i].id = i;
-	  td[i].c = c;
-	  
-	  errcode =  pthread_create(&t[i], 0, adjust_multistep_level_thread, &td[i]);
-	    
-	  if (errcode) {
-	    std::ostringstream sout;
-	    sout << "Process " << myid
-		 << " adjust_multistep_level: cannot make thread " << i
-		 << ", errcode=" << errcode;
-	    throw GenericError(sout.str(), __FILE__, __LINE__, 1024, true);
-	  }
-#ifdef DEBUG
-	  else {
-	    cout << "Process " << myid << ": thread <" << i << "> created\n";
-	  }
-#endif
-	}
-	  
-	//
-	// Collapse the threads
-	//
-	for (int i=0; i<nthrds; i++) {
-	  if ((errcode=pthread_join(t[i], &retval))) {
-	    std::ostringstream sout;
-	    sout << "Process " << myid
-		 << " adjust_multistep_level: thread join " << i
-		 << " failed, errcode=" << errcode;
-	    throw GenericError(sout.str(), __FILE__, __LINE__, 1024, true);
-	  }
-#ifdef DEBUG    
-	  cout << "Process " << myid 
-	       << ": multistep thread <" << i << "> thread exited\n";
-#endif
-	}
+      for (int i=0; i<nthrds; i++) {
+	td[i].level = level;
+	td[i].id = i;
+	td[i].c = c;
       }
+
+      //
+      // Run on the persistent thread pool
+      //
+      ThreadPool::get().run([td](int i) { adjust_multistep_level_thread(&td[i]); });
     }
 
     // Accumulate counters for all threads at the master step boundary
@@ -518,7 +464,6 @@ void adjust_multistep_level()
   }
 
   delete [] td;
-  delete [] t;
 
   //
   // Finish the update
@@ -537,7 +482,10 @@ void adjust_multistep_level()
     //
     if (apply) {
       c->force->multistep_update_finish();
-      c->reset_level_lists();
+				// Only the active levels can change
+      int first = mfirst[mdrft];
+      if (firstCall or (this_step==0 and mstep==0)) first = 0;
+      c->reset_level_lists(first);
     }
     
     c->fix_positions();
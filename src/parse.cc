@@ -92,11 +92,16 @@ void initialize(void)
     if (_G["nreport"])	     nreport    = _G["nreport"].as<int>();
     if (_G["nbalance"])      nbalance   = _G["nbalance"].as<int>();
     if (_G["dbthresh"])      dbthresh   = _G["dbthresh"].as<double>();
+    if (_G["costbalance"])   costbalance = _G["costbalance"].as<bool>();
+    if (_G["nprofile"])      nprofile   = _G["nprofile"].as<int>();
+    if (_G["profile_fmt"])   profile_fmt = _G["profile_fmt"].as<std::string>();
     
     if (_G["time"])          tnow       = _G["time"].as<double>();
     if (_G["dtime"])         dtime      = _G["dtime"].as<double>();
     if (_G["maxMindt"])      max_mindt  = _G["maxMindt"].as<double>();
     if (_G["PFbufsz"])       PFbufsz    = _G["PFbufsz"].as<int>();
+    if (_G["PFalltoall"])    PFalltoall = _G["PFalltoall"].as<bool>();
+    if (_G["pinthreads"])    pinthreads = _G["pinthreads"].as<bool>();
     if (_G["NICE"])          NICE       = _G["NICE"].as<int>();
     if (_G["VERBOSE"])       VERBOSE    = _G["VERBOSE"].as<int>();
     if (_G["rlimit"])        rlimit_val = _G["rlimit"].as<int>();
@@ -344,10 +349,15 @@ void update_parm()
     if (not conf["nreport"])       conf["nreport"]     = nreport;
     if (not conf["nbalance"])      conf["nbalance"]    = nbalance;
     if (not conf["dbthresh"])      conf["dbthresh"]    = dbthresh;
+    if (not conf["costbalance"])   conf["costbalance"] = costbalance;
+    if (not conf["nprofile"])      conf["nprofile"]    = nprofile;
+    if (not conf["profile_fmt"])   conf["profile_fmt"] = profile_fmt;
     
     if (not conf["time"])          conf["time"]        = tnow;
     if (not conf["dtime"])         conf["dtime"]       = dtime;
     if (not conf["PFbufsz"])       conf["PFbufsz"]     = PFbufsz;
+    if (not conf["PFalltoall"])    conf["PFalltoall"]  = PFalltoall;
+    if (not conf["pinthreads"])    conf["pinthreads"]  = pinthreads;
     if (not conf["NICE"])          conf["NICE"]        = NICE;
     if (not conf["VERBOSE"])       conf["VERBOSE"]     = VERBOSE;
     if (not conf["rlimit"])        conf["rlimit"]      = rlimit_val;
@@ -24,12 +24,16 @@
 #endif
 
 #include <NVTX.H>
+#include <Profile.H>
 
 static Timer timer_coef, timer_drift, timer_vel, timer_out, timer_lev;
 static Timer timer_pot , timer_adj  , timer_tot, timer_bal, timer_rpt;
 
 static unsigned tskip = 1;
 
+// Step timer values at the last profile sample
+static std::vector<double> profLast;
+
 inline void check_bad(const char *msg)
 {
 #ifdef CHK_BADV
@@ -74,6 +78,10 @@ void do_step(int n)
   //
   if (VERBOSE>3) step_timing = true;
 
+  // The step timers also feed the instrumentation profile
+  //
+  bool timing = step_timing or Profile::enabled();
+
   //========================
   // Advance using leapfrog 
   // algorithm:
@@ -87,7 +95,7 @@ void do_step(int n)
 
   // Start the total step timer
   //
-  if (step_timing) timer_tot.start();
+  if (timing) timer_tot.start();
 
   // set up CUDA tracer
   //
@@ -101,9 +109,9 @@ void do_step(int n)
 
 				// COM update:
 				// First velocity half-kick
-    if (step_timing) timer_vel.start();
+    if (timing) timer_vel.start();
     incr_com_velocity(0.5*dtime); 
-    if (step_timing) timer_vel.stop();
+    if (timing) timer_vel.stop();
 
 #ifdef CHK_STEP
     vector<double> pos_check(multistep+1);
@@ -117,10 +125,10 @@ void do_step(int n)
       mdrft = mstep;		// Assign velocity position
 
 				// Write multistep output
-      if (step_timing) timer_out.start();
+      if (timing) timer_out.start();
       if (cuda_prof) tPtr = std::make_shared<nvTracer>("Data output");
       output->Run(n, mstep);
-      if (step_timing) timer_out.stop();
+      if (timing) timer_out.stop();
 
       // Compute next coefficients for particles that move on this
       // step (the "active" particles)
@@ -136,12 +144,12 @@ void do_step(int n)
 	if (cuda_prof) {
 	  tPtr2 = std::make_shared<nvTracer>("Velocity kick [1]");
 	}
-	if (step_timing) timer_vel.start();
+	if (timing) timer_vel.start();
 	incr_velocity(0.5*DT, M);
 #ifdef CHK_STEP
 	vel_check[M] += 0.5*DT;
 #endif
-	if (step_timing) timer_vel.stop();
+	if (timing) timer_vel.stop();
 
 	check_bad("after incr_vel", M);
 
@@ -151,12 +159,12 @@ void do_step(int n)
 	  tPtr2.reset();
 	  tPtr2 = std::make_shared<nvTracer>("Drift");
 	}
-	if (step_timing) timer_drift.start();
+	if (timing) timer_drift.start();
 	incr_position(DT, M);
 #ifdef CHK_STEP
 	pos_check[M] += DT;
 #endif
-	if (step_timing) timer_drift.stop();
+	if (timing) timer_drift.stop();
 
 	check_bad("after incr_pos", M);
 
@@ -167,27 +175,27 @@ void do_step(int n)
 	  tPtr2.reset();
 	  tPtr2 = std::make_shared<nvTracer>("Expansion");
 	}
-	if (step_timing) timer_coef.start();
+	if (timing) timer_coef.start();
 	comp->compute_expansion(M);
-	if (step_timing) timer_coef.stop();
+	if (timing) timer_coef.stop();
       }
       
       tnow += dt;		// Time at the end of the current step
 
       // COM update: Position drift
       //
-      if (step_timing) timer_drift.start();
+      if (timing) timer_drift.start();
       incr_com_position(dt);
-      if (step_timing) timer_drift.stop();
+      if (timing) timer_drift.stop();
 
       // Compute potential for all the particles active at this step
       //
       nvTracerPtr tPtr1;
       if (cuda_prof) tPtr1 = std::make_shared<nvTracer>("Potential");
-      if (step_timing) timer_pot.start();
+      if (timing) timer_pot.start();
       mdrft = mstep + 1;	// Drifted position in multistep array
       comp->compute_potential(mfirst[mstep]);
-      if (step_timing) timer_pot.stop();
+      if (timing) timer_pot.stop();
 
       check_bad("after compute_potential");
 
@@ -204,14 +212,14 @@ void do_step(int n)
 	tPtr1 = std::make_shared<nvTracer>("Velocity kick [2]");
       }
 
-      if (step_timing) timer_vel.start();
+      if (timing) timer_vel.start();
       for (int M=mfirst[mdrft]; M<=multistep; M++) {
 	incr_velocity(0.5*dt*mintvl[M], M);
 #ifdef CHK_STEP
 	vel_check[M] += 0.5*dt*mintvl[M];
 #endif
       }
-      if (step_timing) timer_vel.stop();
+      if (timing) timer_vel.stop();
 
       check_bad("after multistep advance");
 				// DEBUG
@@ -219,22 +227,22 @@ void do_step(int n)
       comp->multistep_debug();
 #endif
 				// Adjust particle time-step levels
-      if (step_timing) timer_adj.start();
+      if (timing) timer_adj.start();
       adjust_multistep_level();
-      if (step_timing) timer_adj.stop();
+      if (timing) timer_adj.stop();
       
       // Print the level lists
-      if (step_timing) timer_lev.start();
+      if (timing) timer_lev.start();
       if (mdrft==Mstep) comp->print_level_lists(tnow);
-      if (step_timing) timer_lev.stop();
+      if (timing) timer_lev.stop();
     }
     // END: mstep loop
 
     // Write output
-    if (step_timing) timer_out.start();
+    if (timing) timer_out.start();
     if (cuda_prof) tPtr = std::make_shared<nvTracer>("Data output");
     output->Run(n);
-    if (step_timing) timer_out.stop();
+    if (timing) timer_out.stop();
 
     if (cuda_prof) {
       tPtr = std::make_shared<nvTracer>("Adjust multistep");
@@ -242,9 +250,9 @@ void do_step(int n)
 
     // COM update: second velocity half-kick
     //
-    if (step_timing) timer_vel.start();
+    if (timing) timer_vel.start();
     incr_com_velocity(0.5*dtime);
-    if (step_timing) timer_vel.stop();
+    if (timing) timer_vel.stop();
 
 #ifdef CHK_STEP
 				// Check steps
@@ -275,74 +283,104 @@ void do_step(int n)
 				// Velocity by 1/2 step
     nvTracerPtr tPtr1;
     if (cuda_prof) tPtr1 = std::make_shared<nvTracer>("Velocity kick [1]");
-    if (step_timing) timer_vel.start();
+    if (timing) timer_vel.start();
     incr_velocity(0.5*dtime);
     incr_com_velocity(0.5*dtime);
-    if (step_timing) timer_vel.stop();
+    if (timing) timer_vel.stop();
 				// Position by whole step
     if (cuda_prof) {
       tPtr1.reset();
       tPtr1 = std::make_shared<nvTracer>("Drift");
     }
-    if (step_timing) timer_drift.start();
+    if (timing) timer_drift.start();
     incr_position(dtime);
     incr_com_position(dtime);
-    if (step_timing) timer_drift.stop();
+    if (timing) timer_drift.stop();
 
 				// Compute coefficients
-    if (step_timing) timer_coef.start();
+    if (timing) timer_coef.start();
     comp->compute_expansion(0);
-    if (step_timing) timer_coef.stop();
+    if (timing) timer_coef.stop();
 
 				// Compute acceleration
     if (cuda_prof) {
       tPtr1.reset();
       tPtr1 = std::make_shared<nvTracer>("Potential");
     }
-    if (step_timing) timer_pot.start();
+    if (timing) timer_pot.start();
     comp->compute_potential();
-    if (step_timing) timer_pot.stop();
+    if (timing) timer_pot.stop();
 				// Velocity by 1/2 step
     if (cuda_prof) {
       tPtr1.reset();
       tPtr1 = std::make_shared<nvTracer>("Velocity kick [2]");
     }
-    if (step_timing) timer_vel.start();
+    if (timing) timer_vel.start();
     incr_velocity(0.5*dtime);
     incr_com_velocity(0.5*dtime);
-    if (step_timing) timer_vel.stop();
+    if (timing) timer_vel.stop();
 
                                  // Write output
-    if (step_timing) timer_out.start();
+    if (timing) timer_out.start();
     nvTracerPtr tPtr;
     if (cuda_prof) tPtr = std::make_shared<nvTracer>("Data output");
     output->Run(n);
-    if (step_timing) timer_out.stop();
+    if (timing) timer_out.stop();
 
   }
   // END: multistep=0 block
 
 				// Summarize processor particle load
 
-  if (step_timing) timer_rpt.start();
+  if (timing) timer_rpt.start();
   comp->report_numbers();
-  if (step_timing) timer_rpt.stop();
+  if (timing) timer_rpt.stop();
 
 				// Load balance
   if (cuda_prof) {
     tPtr.reset();
     tPtr = std::make_shared<nvTracer>("Load balance");
   }
-  if (step_timing) timer_bal.start();
+  if (timing) timer_bal.start();
   comp->load_balance();
-  if (step_timing) timer_bal.stop();
+  if (timing) timer_bal.stop();
 
 				// Stop the total step timer
-  if (step_timing) timer_tot.stop();
+  if (timing) timer_tot.stop();
 
   if (VERBOSE==2 and myid==0) 	// Time step marker
     std::cout << std::endl << ">>>" << this_step << "<<<" << std::endl;
 
+				// Stage times for the profile are the
+				// changes in the step timers since the
+				// last step; the timers themselves are
+				// only reset by the timer report
+  if (Profile::enabled()) {
+    static const std::vector<std::pair<const char*, Timer*>> stages =
+      { {"step.drift",    &timer_drift},
+	{"step.velocity", &timer_vel  },
+	{"step.force",    &timer_pot  },
+	{"step.coefs",    &timer_coef },
+	{"step.output",   &timer_out  },
+	{"step.levels",   &timer_lev  },
+	{"step.report",   &timer_rpt  },
+	{"step.balance",  &timer_bal  },
+	{"step.adjust",   &timer_adj  },
+	{"step.total",    &timer_tot  } };
+
+    static std::vector<int> ids;
+    if (ids.size()==0)
+      for (auto & s : stages) ids.push_back(Profile::region(s.first));
+
+    profLast.resize(stages.size(), 0.0);
+
+    for (size_t i=0; i<stages.size(); i++) {
+      double t = stages[i].second->getTime();
+      Profile::add(ids[i], t - profLast[i]);
+      profLast[i] = t;
+    }
+  }
+
 				// Timer output
   if (step_timing && this_step!=0 && (this_step % tskip) == 0) {
     if (myid==0) {
@@ -440,8 +478,12 @@ void do_step(int n)
     timer_tot  .reset();
     if (use_cuda) comp->timer_cuda.reset();
     if (use_cuda) comp->timer_orient.reset();
+
+    std::fill(profLast.begin(), profLast.end(), 0.0);
   }
 
+  if (Profile::enabled()) Profile::report(this_step);
+
 #ifdef USE_GPTL
   GPTLstop("dostep");
 #endif
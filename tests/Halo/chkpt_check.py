@@ -0,0 +1,35 @@
+# Compare the phase space of the run restarted from an incremental
+# checkpoint (runB) with the uninterrupted reference run (runR).  The
+# files are ascii conversions of the final PSP outputs by psp2ascii
+# with the columns: index, mass, pos[3], vel[3], potential, ...
+
+def read(name):
+    data = {}
+    with open(name) as file:
+        file.readline()         # Skip the header
+        for line in file:
+            v = line.split()
+            data[int(v[0])] = [float(x) for x in v[1:8]]
+    return data
+
+restart = read("runB.halo")
+reference = read("runR.halo")
+
+if len(restart) == 0 or restart.keys() != reference.keys():
+    print("Particle indices differ")
+    exit(1)
+
+# Largest relative difference in mass, position and velocity
+#
+worst = 0.0
+for n, a in restart.items():
+    b = reference[n]
+    for x, y in zip(a, b):
+        worst = max(worst, abs(x - y)/max(1.0e-8, abs(y)))
+
+print("Largest relative difference:", worst)
+
+if worst > 1.0e-6:
+    exit(1)
+else:
+    exit(0)